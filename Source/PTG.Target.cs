@@ -10,6 +10,6 @@ public class PTGTarget : TargetRules
 		Type = TargetType.Game;
 		DefaultBuildSettings = BuildSettingsVersion.V5;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_4;
-		ExtraModuleNames.Add("PTG");
+		ExtraModuleNames.AddRange(new string[] { "PTG", "PTGShaders" });
 	}
 }
@@ -0,0 +1,325 @@
+#include "PTG/Core/Benchmark/PTGBenchmarkCommandlet.h"
+#include "PTG/PTG.h"
+#include "ProceduralMeshComponent.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PTG/Generation/Subsystems/ProceduralMeshGeneratorSubsystem.h"
+#include "PTG/Generation/Terrain/ChunkScheduler.h"
+#include "PTG/Generation/Terrain/ChunkThread.h"
+#include "PTG/Generation/Terrain/TerrainLayerGraph.h"
+#include "PTG/Generation/Utils/PerlinNoise.h"
+
+/**
+ * @file PTGBenchmarkCommandlet.cpp
+ * @brief Implementation of the generation pipeline benchmark
+ * @details Times the noise kernel, chunk fill, mesh build and mesh upload separately, then the worker pool throughput,
+ *          over a matrix of chunk sizes, octave counts and thread counts. Results are written as CSV and JSON
+ */
+
+//////// HELPERS ////////
+/**
+ * @brief Parses a comma separated list of integers from the command line
+ * @param Params Command line
+ * @param Key Switch name, without the dash and equal sign
+ * @param Default Values used when the switch is absent
+ * @return Parsed values
+ */
+static TArray<int32> ParseIntList(const FString& Params, const TCHAR* Key, TArray<int32> Default)
+{
+	FString Value;
+	if (!FParse::Value(*Params, *FString::Printf(TEXT("%s="), Key), Value, false))
+	{
+		return Default;
+	}
+
+	TArray<FString> Items;
+	Value.ParseIntoArray(Items, TEXT(","));
+
+	TArray<int32> Values;
+	for (const FString& Item : Items)
+	{
+		Values.Add(FMath::Max(FCString::Atoi(*Item), 1));
+	}
+	return Values.Num() > 0 ? Values : Default;
+}
+
+/**
+ * @brief Creates the chunk of a benchmark grid
+ * @param Index Chunk index, chunks are laid out along rows of 16 without overlapping
+ * @param ChunkSize Size of chunk in vertices
+ * @return Chunk ready to be generated
+ */
+static FChunk MakeBenchmarkChunk(int32 Index, int32 ChunkSize)
+{
+	FChunk Chunk;
+	Chunk.Size = ChunkSize;
+	Chunk.Coords = FVector((Index % 16) * (ChunkSize - 1), (Index / 16) * (ChunkSize - 1), 0);
+	Chunk.Id = ChunkData::GetChunkIdFromCoordinates(Chunk.Coords.X, Chunk.Coords.Y);
+	return Chunk;
+}
+
+/**
+ * @brief Nearest rank percentile of sorted values
+ * @param Sorted Values in ascending order
+ * @param Percentile Percentile in [0, 100]
+ * @return Value at the percentile, 0 when empty
+ */
+static double GetPercentile(const TArray<double>& Sorted, double Percentile)
+{
+	if (Sorted.Num() == 0)
+	{
+		return 0.0;
+	}
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile / 100.0 * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+	return Sorted[Index];
+}
+
+UPTGBenchmarkCommandlet::UPTGBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+/**
+ * @brief Runs the benchmark matrix
+ * @param Params Command line switches, see the class comment
+ * @return 0 on success, 1 if the reports could not be written
+ */
+int32 UPTGBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TArray<int32> Sizes = ParseIntList(Params, TEXT("Sizes"), { 33, 65, 129 });
+	const TArray<int32> OctaveCounts = ParseIntList(Params, TEXT("Octaves"), { 4, 8 });
+	const TArray<int32> ThreadCounts = ParseIntList(Params, TEXT("Threads"), { 1, FChunkScheduler::GetDefaultWorkerCount() });
+
+	int32 NumChunks = 64;
+	FParse::Value(*Params, TEXT("Chunks="), NumChunks);
+	NumChunks = FMath::Max(NumChunks, 1);
+
+	FPerlinParameters Parameters;
+	Parameters.Frequency = 0.1f;
+	Parameters.Persistence = 0.5f;
+	Parameters.Seed = 420;
+	Parameters.HeightFactor = 100;
+	Parameters.Version = EPerlinNoiseVersion::Hashed;
+
+	FString VersionName;
+	if (FParse::Value(*Params, TEXT("Version="), VersionName))
+	{
+		const int64 Version = StaticEnum<EPerlinNoiseVersion>()->GetValueByNameString(VersionName);
+		if (Version != INDEX_NONE)
+		{
+			Parameters.Version = (EPerlinNoiseVersion)Version;
+		}
+	}
+
+	FString OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), FString::Printf(TEXT("PTGBenchmark-%s"), *FDateTime::Now().ToString()));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	for (int32 ChunkSize : Sizes)
+	{
+		for (int32 Octaves : OctaveCounts)
+		{
+			Parameters.Octaves = Octaves;
+			UE_LOG(LogPTG, Display, TEXT("Benchmarking ChunkSize %d, %d octaves"), ChunkSize, Octaves);
+
+			RunSingleThreadedStages(FMath::Max(ChunkSize, 2), Parameters, NumChunks);
+			for (int32 NumThreads : ThreadCounts)
+			{
+				RunThroughputStage(FMath::Max(ChunkSize, 2), Parameters, NumChunks, NumThreads);
+			}
+		}
+	}
+
+	for (const FStageResult& Result : Results)
+	{
+		UE_LOG(LogPTG, Display, TEXT("%-10s size %4d octaves %2d threads %2d: %10.0f samples/s %8.1f chunks/s p50 %.3f ms p99 %.3f ms"),
+			*Result.Stage, Result.ChunkSize, Result.Octaves, Result.Threads, Result.SamplesPerSecond, Result.ChunksPerSecond, Result.P50Ms, Result.P99Ms);
+	}
+
+	return WriteReports(OutputPath) ? 0 : 1;
+}
+
+/**
+ * @brief Times each pipeline stage on the calling thread
+ * @param ChunkSize Size of chunks in vertices
+ * @param Parameters Noise parameters
+ * @param NumChunks Chunks measured per stage
+ * @details Every chunk goes through the stages in order so each stage sees the output of the previous one,
+ *          but only the stage itself is inside its timer
+ */
+void UPTGBenchmarkCommandlet::RunSingleThreadedStages(int32 ChunkSize, const FPerlinParameters& Parameters, int32 NumChunks)
+{
+	const FChunkTopologyPtr Topology = UProceduralMeshGeneratorSubsystem::BuildChunkTopology(ChunkSize, 0, false);
+	// Jobs without layer settings generate with the defaults, the kernel is timed with the same smoothing
+	const FTerrainLayerSettings Layers;
+	const FVector2D Eps = FTerrainLayerGraph::SmoothingEpsilon;
+	UProceduralMeshComponent* ProceduralMesh = NewObject<UProceduralMeshComponent>(GetTransientPackage());
+
+	TArray<double> KernelSeconds, FillSeconds, MeshSeconds, UploadSeconds;
+	TArray<float> Values;
+	Values.SetNumUninitialized(ChunkSize * ChunkSize);
+
+	for (int32 i = 0; i < NumChunks; i++)
+	{
+		FChunkJob Job(MakeBenchmarkChunk(i, ChunkSize), Parameters, Parameters, 0.0f);
+		Job.Topology = Topology;
+		const FVector2f Origin(Job.Chunk.Coords.X, Job.Chunk.Coords.Y);
+
+		// Noise kernel, lattice built outside the timer
+		FPerlinLatticeCache Lattice;
+		Lattice.Build(Origin, UPerlinNoise::GetTileMaxCoordinates(Origin, 1.0f, ChunkSize, ChunkSize, Eps),
+			Parameters.Octaves, Parameters.Frequency, Parameters.Seed, Parameters.Version);
+
+		double StartTime = FPlatformTime::Seconds();
+		UPerlinNoise::GenerateOctavePerlinSmoothedTile(Values.GetData(), Origin, 1.0f, ChunkSize, ChunkSize, ChunkSize,
+			Parameters.Octaves, Parameters.Persistence, Parameters.Frequency, Parameters.Seed, Layers.GradientPower, Layers.GradientSmoothing, Eps, Parameters.Version, &Lattice);
+		KernelSeconds.Add(FPlatformTime::Seconds() - StartTime);
+
+		// Chunk fill, the whole noise stage of a worker
+		StartTime = FPlatformTime::Seconds();
+		FChunkThread::GenerateChunk(Job);
+		FillSeconds.Add(FPlatformTime::Seconds() - StartTime);
+
+		// Mesh build, aprons and buffers
+		StartTime = FPlatformTime::Seconds();
+		FChunkThread::GenerateApron(Job);
+		FChunkThread::BuildMesh(Job);
+		MeshSeconds.Add(FPlatformTime::Seconds() - StartTime);
+
+		// Upload of the render section to a standalone component, it cooks no collision. Collision sections are built by CreateChunkCollision and not timed
+		StartTime = FPlatformTime::Seconds();
+		UProceduralMeshGeneratorSubsystem::UploadChunkMesh(ProceduralMesh, *Job.MeshData, 0);
+		UploadSeconds.Add(FPlatformTime::Seconds() - StartTime);
+		ProceduralMesh->ClearMeshSection(0);
+	}
+
+	auto Sum = [](const TArray<double>& Seconds) { double Total = 0.0; for (double Value : Seconds) { Total += Value; } return Total; };
+	AddResult(TEXT("Kernel"), ChunkSize, Parameters.Octaves, 1, KernelSeconds, Sum(KernelSeconds));
+	AddResult(TEXT("Fill"), ChunkSize, Parameters.Octaves, 1, FillSeconds, Sum(FillSeconds));
+	AddResult(TEXT("MeshBuild"), ChunkSize, Parameters.Octaves, 1, MeshSeconds, Sum(MeshSeconds));
+	AddResult(TEXT("Upload"), ChunkSize, Parameters.Octaves, 1, UploadSeconds, Sum(UploadSeconds));
+
+	ProceduralMesh->MarkAsGarbage();
+}
+
+/**
+ * @brief Times the worker pool generating a batch of chunks
+ * @param ChunkSize Size of chunks in vertices
+ * @param Parameters Noise parameters
+ * @param NumChunks Chunks in the batch
+ * @param NumThreads Number of workers
+ * @details Measures the wall time from the batch being queued to the last chunk being completed, noise and mesh stages included.
+ *          Percentiles are taken over the worker time of each chunk, from its dequeue to its completion, so they
+ *          do not include the time spent waiting in the queue
+ */
+void UPTGBenchmarkCommandlet::RunThroughputStage(int32 ChunkSize, const FPerlinParameters& Parameters, int32 NumChunks, int32 NumThreads)
+{
+	const FChunkTopologyPtr Topology = UProceduralMeshGeneratorSubsystem::BuildChunkTopology(ChunkSize, 0, false);
+	FChunkScheduler Scheduler(NumThreads, TPri_Normal);
+
+	TArray<FChunkJobRef> Jobs;
+	Jobs.Reserve(NumChunks);
+	for (int32 i = 0; i < NumChunks; i++)
+	{
+		FChunkJobRef Job = MakeShared<FChunkJob, ESPMode::ThreadSafe>(MakeBenchmarkChunk(i, ChunkSize), Parameters, Parameters, (float)i);
+		Job->Topology = Topology;
+		Jobs.Add(Job);
+	}
+
+	TArray<double> ChunkSeconds;
+	ChunkSeconds.Reserve(NumChunks);
+
+	const double StartTime = FPlatformTime::Seconds();
+	Scheduler.EnqueueBatch(Jobs);
+
+	FChunkJobPtr CompletedJob;
+	while (ChunkSeconds.Num() < NumChunks)
+	{
+		if (Scheduler.DequeueCompletedJob(CompletedJob))
+		{
+			ChunkSeconds.Add(CompletedJob->WorkerSeconds);
+		}
+		else
+		{
+			FPlatformProcess::Sleep(0.0f);
+		}
+	}
+
+	const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+	AddResult(TEXT("Pool"), ChunkSize, Parameters.Octaves, Scheduler.GetNumWorkers(), ChunkSeconds, TotalSeconds);
+}
+
+/**
+ * @brief Records the measurement of a stage
+ * @param Stage Stage name
+ * @param ChunkSize Size of chunks in vertices
+ * @param Octaves Octave count
+ * @param Threads Threads used by the stage
+ * @param ChunkSeconds Time of each chunk, sorted in place
+ * @param TotalSeconds Wall time of the stage
+ */
+void UPTGBenchmarkCommandlet::AddResult(const FString& Stage, int32 ChunkSize, int32 Octaves, int32 Threads, TArray<double>& ChunkSeconds, double TotalSeconds)
+{
+	ChunkSeconds.Sort();
+
+	FStageResult& Result = Results.AddDefaulted_GetRef();
+	Result.Stage = Stage;
+	Result.ChunkSize = ChunkSize;
+	Result.Octaves = Octaves;
+	Result.Threads = Threads;
+	Result.Chunks = ChunkSeconds.Num();
+	Result.TotalSeconds = TotalSeconds;
+
+	if (TotalSeconds > 0.0)
+	{
+		Result.ChunksPerSecond = Result.Chunks / TotalSeconds;
+		Result.SamplesPerSecond = Result.ChunksPerSecond * ChunkSize * ChunkSize;
+	}
+
+	if (Result.Chunks > 0)
+	{
+		double Sum = 0.0;
+		for (double Seconds : ChunkSeconds)
+		{
+			Sum += Seconds;
+		}
+		Result.MeanMs = Sum / Result.Chunks * 1000.0;
+		Result.P50Ms = GetPercentile(ChunkSeconds, 50.0) * 1000.0;
+		Result.P90Ms = GetPercentile(ChunkSeconds, 90.0) * 1000.0;
+		Result.P99Ms = GetPercentile(ChunkSeconds, 99.0) * 1000.0;
+	}
+}
+
+/**
+ * @brief Writes the results as CSV and JSON
+ * @param BasePath Path of the reports without extension
+ * @return True if both files were written
+ */
+bool UPTGBenchmarkCommandlet::WriteReports(const FString& BasePath) const
+{
+	FString Csv = TEXT("stage,chunk_size,octaves,threads,chunks,total_s,samples_per_s,chunks_per_s,mean_ms,p50_ms,p90_ms,p99_ms\n");
+	FString Json = TEXT("{\n\t\"results\": [\n");
+
+	for (int32 i = 0; i < Results.Num(); i++)
+	{
+		const FStageResult& Result = Results[i];
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%.6f,%.1f,%.3f,%.4f,%.4f,%.4f,%.4f\n"),
+			*Result.Stage, Result.ChunkSize, Result.Octaves, Result.Threads, Result.Chunks, Result.TotalSeconds,
+			Result.SamplesPerSecond, Result.ChunksPerSecond, Result.MeanMs, Result.P50Ms, Result.P90Ms, Result.P99Ms);
+
+		Json += FString::Printf(TEXT("\t\t{ \"stage\": \"%s\", \"chunk_size\": %d, \"octaves\": %d, \"threads\": %d, \"chunks\": %d, \"total_s\": %.6f, ")
+			TEXT("\"samples_per_s\": %.1f, \"chunks_per_s\": %.3f, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f }%s\n"),
+			*Result.Stage, Result.ChunkSize, Result.Octaves, Result.Threads, Result.Chunks, Result.TotalSeconds,
+			Result.SamplesPerSecond, Result.ChunksPerSecond, Result.MeanMs, Result.P50Ms, Result.P90Ms, Result.P99Ms,
+			i + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+	}
+	Json += TEXT("\t]\n}\n");
+
+	const bool bCsvWritten = FFileHelper::SaveStringToFile(Csv, *(BasePath + TEXT(".csv")));
+	const bool bJsonWritten = FFileHelper::SaveStringToFile(Json, *(BasePath + TEXT(".json")));
+	UE_LOG(LogPTG, Display, TEXT("Benchmark reports written to %s.csv and .json"), *BasePath);
+	return bCsvWritten && bJsonWritten;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PTG/Generation/Terrain/ChunkData.h"
+#include "PTGBenchmarkCommandlet.generated.h"
+
+//////// CLASS ////////
+/**
+ * Benchmarks the chunk generation pipeline stage by stage
+ * Usage: UnrealEditor-Cmd PTG.uproject -run=PTGBenchmark [-Sizes=33,65] [-Octaves=4,8] [-Threads=1,4] [-Chunks=64] [-Version=Hashed] [-Output=Path]
+ */
+UCLASS()
+class PTG_API UPTGBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	//////// CONSTRUCTORS ////////
+	UPTGBenchmarkCommandlet();
+
+	//////// UNREAL LIFECYCLE ////////
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	//////// FIELDS ////////
+	/// Measurement of one stage for one configuration
+	struct FStageResult
+	{
+		FString Stage;
+		int32 ChunkSize = 0;
+		int32 Octaves = 0;
+		int32 Threads = 1;
+		int32 Chunks = 0;
+		double TotalSeconds = 0.0;
+		double SamplesPerSecond = 0.0;
+		double ChunksPerSecond = 0.0;
+		double MeanMs = 0.0;
+		double P50Ms = 0.0;
+		double P90Ms = 0.0;
+		double P99Ms = 0.0;
+	};
+
+	TArray<FStageResult> Results;
+
+	//////// METHODS ////////
+	/// Stages
+	void RunSingleThreadedStages(int32 ChunkSize, const FPerlinParameters& Parameters, int32 NumChunks);
+	void RunThroughputStage(int32 ChunkSize, const FPerlinParameters& Parameters, int32 NumChunks, int32 NumThreads);
+
+	/// Reports
+	void AddResult(const FString& Stage, int32 ChunkSize, int32 Octaves, int32 Threads, TArray<double>& ChunkSeconds, double TotalSeconds);
+	bool WriteReports(const FString& BasePath) const;
+};
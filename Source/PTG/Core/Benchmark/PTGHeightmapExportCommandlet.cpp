@@ -0,0 +1,82 @@
+#include "PTG/Core/Benchmark/PTGHeightmapExportCommandlet.h"
+#include "PTG/PTG.h"
+#include "Misc/Paths.h"
+#include "PTG/Core/GameMode/PTGGameMode.h"
+#include "PTG/Generation/Terrain/HeightmapExporter.h"
+
+/**
+ * @file PTGHeightmapExportCommandlet.cpp
+ * @brief Implementation of the offline heightmap bake
+ * @details Reads the noise parameters and layers from the defaults of a game mode class, so the baked heights are the
+ *          ones its chunks are generated with
+ */
+
+UPTGHeightmapExportCommandlet::UPTGHeightmapExportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+/**
+ * @brief Runs the export
+ * @param Params Command line switches, see the class comment
+ * @return 0 on success, 1 if the game mode could not be loaded or the file could not be written
+ */
+int32 UPTGHeightmapExportCommandlet::Main(const FString& Params)
+{
+	UClass* GameModeClass = APTGGameMode::StaticClass();
+	FString GameModePath;
+	if (FParse::Value(*Params, TEXT("GameMode="), GameModePath))
+	{
+		GameModeClass = LoadClass<APTGGameMode>(nullptr, *GameModePath);
+		if (!GameModeClass)
+		{
+			UE_LOG(LogPTG, Error, TEXT("Heightmap export: %s is not a PTG game mode class"), *GameModePath);
+			return 1;
+		}
+	}
+	const APTGGameMode* GameMode = GetDefault<APTGGameMode>(GameModeClass);
+
+	FHeightmapExportSettings Settings;
+	FParse::Value(*Params, TEXT("Size="), Settings.Size.X);
+	Settings.Size.Y = Settings.Size.X;
+	FParse::Value(*Params, TEXT("SizeY="), Settings.Size.Y);
+	FParse::Value(*Params, TEXT("OriginX="), Settings.Origin.X);
+	FParse::Value(*Params, TEXT("OriginY="), Settings.Origin.Y);
+	FParse::Value(*Params, TEXT("Step="), Settings.SampleStep);
+	FParse::Value(*Params, TEXT("HeightMin="), Settings.HeightRange.X);
+	FParse::Value(*Params, TEXT("HeightMax="), Settings.HeightRange.Y);
+	FParse::Value(*Params, TEXT("TileSize="), Settings.TileSize);
+
+	FString FormatName;
+	if (FParse::Value(*Params, TEXT("Format="), FormatName))
+	{
+		const int64 Format = StaticEnum<EHeightmapFormat>()->GetValueByNameString(FormatName);
+		if (Format != INDEX_NONE)
+		{
+			Settings.Format = (EHeightmapFormat)Format;
+		}
+	}
+
+	const FHeightmapExporter Exporter(Settings, GameMode->GetTerrainParameters(), GameMode->GetBiomesParameters(), GameMode->GetTerrainLayers());
+
+	FString OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Heightmaps"),
+		FString::Printf(TEXT("PTGHeightmap-%s.%s"), *FDateTime::Now().ToString(), FHeightmapExporter::GetFileExtension(Settings.Format)));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	const FIntPoint Size = Exporter.GetSettings().Size;
+	UE_LOG(LogPTG, Display, TEXT("Exporting %dx%d %s heightmap of %s to %s"), Size.X, Size.Y, *StaticEnum<EHeightmapFormat>()->GetNameStringByValue((int64)Settings.Format),
+		*GameModeClass->GetName(), *OutputPath);
+
+	const double StartTime = FPlatformTime::Seconds();
+	if (!Exporter.ExportToFile(OutputPath))
+	{
+		return 1;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogPTG, Display, TEXT("Heightmap exported in %.1f s, %.0f samples/s"), Seconds, (double)Size.X * Size.Y / FMath::Max(Seconds, UE_SMALL_NUMBER));
+	return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PTGHeightmapExportCommandlet.generated.h"
+
+//////// CLASS ////////
+/**
+ * Bakes the terrain of a game mode to a raw heightmap, streamed to disk a row of tiles at a time
+ * Usage: UnrealEditor-Cmd PTG.uproject -run=PTGHeightmapExport [-GameMode=ClassPath] [-Size=16384] [-SizeY=16384] [-OriginX=0] [-OriginY=0]
+ *        [-Step=1] [-Format=G16|R32F] [-HeightMin=0] [-HeightMax=100004] [-TileSize=256] [-Output=Path]
+ */
+UCLASS()
+class PTG_API UPTGHeightmapExportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	//////// CONSTRUCTORS ////////
+	UPTGHeightmapExportCommandlet();
+
+	//////// UNREAL LIFECYCLE ////////
+	virtual int32 Main(const FString& Params) override;
+};
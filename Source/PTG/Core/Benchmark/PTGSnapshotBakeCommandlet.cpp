@@ -0,0 +1,64 @@
+#include "PTG/Core/Benchmark/PTGSnapshotBakeCommandlet.h"
+#include "PTG/PTG.h"
+#include "Misc/Paths.h"
+#include "PTG/Core/GameMode/PTGGameMode.h"
+#include "PTG/Generation/Subsystems/ChunkManagerWorldSubsystem.h"
+#include "PTG/Generation/Terrain/TerrainSnapshot.h"
+
+/**
+ * @file PTGSnapshotBakeCommandlet.cpp
+ * @brief Implementation of the startup snapshot bake
+ * @details Reads the noise parameters, layers and streaming settings from the defaults of a game mode class, so the
+ *          snapshot matches the terrain the game mode generates. The snapshot is ignored at runtime once they change
+ */
+
+UPTGSnapshotBakeCommandlet::UPTGSnapshotBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+/**
+ * @brief Runs the bake
+ * @param Params Command line switches, see the class comment
+ * @return 0 on success, 1 if the game mode could not be loaded or the file could not be written
+ */
+int32 UPTGSnapshotBakeCommandlet::Main(const FString& Params)
+{
+	UClass* GameModeClass = APTGGameMode::StaticClass();
+	FString GameModePath;
+	if (FParse::Value(*Params, TEXT("GameMode="), GameModePath))
+	{
+		GameModeClass = LoadClass<APTGGameMode>(nullptr, *GameModePath);
+		if (!GameModeClass)
+		{
+			UE_LOG(LogPTG, Error, TEXT("Snapshot bake: %s is not a PTG game mode class"), *GameModePath);
+			return 1;
+		}
+	}
+	const APTGGameMode* GameMode = GetDefault<APTGGameMode>(GameModeClass);
+
+	int32 Radius = GameMode->GetRenderDistance();
+	FParse::Value(*Params, TEXT("Radius="), Radius);
+	Radius = FMath::Max(Radius, 0);
+
+	int32 ChunkSize = GetDefault<UChunkManagerWorldSubsystem>()->GetChunkSize();
+	FParse::Value(*Params, TEXT("ChunkSize="), ChunkSize);
+	ChunkSize = FMath::Max(ChunkSize, 2);
+
+	FString OutputPath = FPaths::Combine(FPaths::ProjectContentDir(), TEXT("PTG"), TEXT("Snapshots"), TEXT("Spawn.ptgs"));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	UE_LOG(LogPTG, Display, TEXT("Baking %d chunks of %s to %s"), ChunkData::GetInitialChunkCount(Radius), *GameModeClass->GetName(), *OutputPath);
+
+	const double StartTime = FPlatformTime::Seconds();
+	if (!FTerrainSnapshot::Bake(OutputPath, ChunkSize, Radius, GameMode->GetTerrainParameters(), GameMode->GetBiomesParameters(), GameMode->GetTerrainLayers(), GameMode->GetStreamingSettings()))
+	{
+		return 1;
+	}
+
+	UE_LOG(LogPTG, Display, TEXT("Snapshot baked in %.1f s"), FPlatformTime::Seconds() - StartTime);
+	return 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PTGSnapshotBakeCommandlet.generated.h"
+
+//////// CLASS ////////
+/**
+ * Bakes the chunks around the spawn of a game mode into a startup snapshot, see FChunkStreamingSettings::StartupSnapshot
+ * Usage: UnrealEditor-Cmd PTG.uproject -run=PTGSnapshotBake [-GameMode=ClassPath] [-Radius=RenderDistance] [-ChunkSize=64] [-Output=Path]
+ */
+UCLASS()
+class PTG_API UPTGSnapshotBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	//////// CONSTRUCTORS ////////
+	UPTGSnapshotBakeCommandlet();
+
+	//////// UNREAL LIFECYCLE ////////
+	virtual int32 Main(const FString& Params) override;
+};
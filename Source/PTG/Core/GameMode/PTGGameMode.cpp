@@ -1,4 +1,5 @@
 ﻿#include "PTGGameMode.h"
+#include "PTG/PTG.h"
 #include "Blueprint/UserWidget.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/PlayerStart.h"
@@ -86,7 +87,9 @@ void APTGGameMode::GenerateInitialChunks()
 	
 	ChunkManager->SetTerrainParameters(TerrainParameters);
 	ChunkManager->SetBiomesParameters(BiomesParameters);
+	ChunkManager->SetTerrainLayers(TerrainLayers);
 	ChunkManager->SetRenderDistance(RenderDistance);
+	ChunkManager->SetStreamingSettings(StreamingSettings);
 
 	if (UTerrainGeneratorWorldSubsystem* TerrainGenerator = GetWorld()->GetSubsystem<UTerrainGeneratorWorldSubsystem>())
 	{
@@ -104,11 +107,11 @@ void APTGGameMode::GenerateInitialChunks()
  */
 void APTGGameMode::HandleGenerationProgress(int32 Current, int32 Total)
 {
-	UE_LOG(LogTemp, Warning, TEXT("Generation Progress: %d/%d"), Current, Total);
+	UE_LOG(LogPTG, Verbose, TEXT("Generation Progress: %d/%d"), Current, Total);
 	
 	if (Current >= Total)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Generation Complete, Repositioning Player"));
+		UE_LOG(LogPTG, Log, TEXT("Generation Complete, Repositioning Player"));
 		RepositionPlayerToGround();
 	}
 }
@@ -142,30 +145,16 @@ void APTGGameMode::RepositionPlayerToGround()
 {
 	if (!ChunkManager)
 	{
-		UE_LOG(LogTemp, Error, TEXT("ChunkManager is null in RepositionPlayerToGround"));
+		UE_LOG(LogPTG, Error, TEXT("ChunkManager is null in RepositionPlayerToGround"));
 		return;
 	}
 
 	if (UTerrainGeneratorWorldSubsystem* TerrainGenerator = GetWorld()->GetSubsystem<UTerrainGeneratorWorldSubsystem>())
 	{
-		int64 CentralChunkId = ChunkData::GetChunkIdFromCoordinates(0, 0);
-		const FChunk* CentralChunk = TerrainGenerator->GetChunk(CentralChunkId);
-        
-		if (!CentralChunk || CentralChunk->VertexArray.Num() == 0)
-		{
-			UE_LOG(LogTemp, Error, TEXT("Central chunk not found or empty"));
-			return;
-		}
-        
-		int32 CenterX = (ChunkManager->GetChunkSize() - 1) / 2;
-		int32 CenterY = (ChunkManager->GetChunkSize() - 1) / 2;
-		int32 CenterIndex = CenterX + CenterY * ChunkManager->GetChunkSize();
-        
-		float TerrainHeight = CentralChunk->VertexArray[CenterIndex].Coords.Z;
-        
 		if (ACharacter* PlayerCharacter = Cast<ACharacter>(GetWorld()->GetFirstPlayerController()->GetPawn()))
 		{
 			FVector CurrentLocation = PlayerCharacter->GetActorLocation();
+			const float TerrainHeight = TerrainGenerator->QueryHeight(FVector2D(CurrentLocation));
 			FVector NewLocation(CurrentLocation.X, CurrentLocation.Y, TerrainHeight + 400.0f);
 
 			PlayerCharacter->SetActorLocation(NewLocation);
@@ -173,11 +162,11 @@ void APTGGameMode::RepositionPlayerToGround()
 		}
 		else
 		{
-			UE_LOG(LogTemp, Error, TEXT("Player character not found"));
+			UE_LOG(LogPTG, Error, TEXT("Player character not found"));
 		}
 	}
 	else 
 	{
-		UE_LOG(LogTemp, Error, TEXT("TerrainGenerator not found in RepositionPlayerToGround"));
+		UE_LOG(LogPTG, Error, TEXT("TerrainGenerator not found in RepositionPlayerToGround"));
 	}
 }
@@ -28,6 +28,13 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void GenerateInitialChunks();
 
+	/// Getters
+	const FPerlinParameters& GetTerrainParameters() const { return TerrainParameters; }
+	const FPerlinParameters& GetBiomesParameters() const { return BiomesParameters; }
+	const FTerrainLayerSettings& GetTerrainLayers() const { return TerrainLayers; }
+	const FChunkStreamingSettings& GetStreamingSettings() const { return StreamingSettings; }
+	int32 GetRenderDistance() const { return RenderDistance; }
+
 protected:
 	//////// FIELDS ////////
 	/// UI Fields
@@ -40,8 +47,12 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Terrain Generation")
 	FPerlinParameters BiomesParameters;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Terrain Generation")
+	FTerrainLayerSettings TerrainLayers;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Terrain Generation")
 	int32 RenderDistance;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Terrain Generation")
+	FChunkStreamingSettings StreamingSettings;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Terrain Generation")
 	UMaterial* Material;
 	
 private:
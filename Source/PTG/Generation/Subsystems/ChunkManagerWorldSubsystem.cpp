@@ -1,5 +1,7 @@
 ﻿#include "PTG/Generation/Subsystems/ChunkManagerWorldSubsystem.h"
 #include "PTG/Generation/Subsystems/TerrainGeneratorWorldSubsystem.h"
+#include "PTG/PTG.h"
+#include "HAL/IConsoleManager.h"
 
 /**
  * @file ChunkManagerWorldSubsystem.cpp
@@ -7,6 +9,19 @@
  * @details Manages chunk loading and unloading based on player position
  */
 
+/// Logs the terrain memory of the world the command is run in, see UChunkManagerWorldSubsystem::LogMemoryReport
+static FAutoConsoleCommandWithWorld GPTGMemoryReportCommand(
+	TEXT("PTG.MemoryReport"),
+	TEXT("Logs the memory held by the terrain chunks against the streaming memory budget"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UChunkManagerWorldSubsystem* ChunkManager = World ? World->GetSubsystem<UChunkManagerWorldSubsystem>() : nullptr)
+		{
+			ChunkManager->LogMemoryReport();
+		}
+	})
+);
+
 void UChunkManagerWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
@@ -27,7 +42,7 @@ void UChunkManagerWorldSubsystem::Initialize(FSubsystemCollectionBase& Collectio
 		}
 		else
 		{
-			UE_LOG(LogTemp, Error, TEXT("Failed to initialize TerrainGenerator"));
+			UE_LOG(LogPTG, Error, TEXT("Failed to initialize TerrainGenerator"));
 			return;
 		}
 
@@ -54,131 +69,1040 @@ void UChunkManagerWorldSubsystem::Deinitialize()
 /**
  * @brief Updates chunk loading state based on player position
  * @param DeltaTime Time elapsed since last tick
- * @details Manages chunk generation and destruction queues based on render distance
+ * @details Manages chunk generation and destruction queues based on render distance.
+ *          With a frame budget, requests are sent to the workers in batches and finished chunks
+ *          are integrated and far chunks destroyed until the game thread budget is spent
  */
 void UChunkManagerWorldSubsystem::Tick(float DeltaTime)
 {
-	if (!bInitialChunksGenerated)
+	if (!TerrainGenerator)
     {
         return;
     }
-    
-    if (APlayerController* PC = GetWorld()->GetFirstPlayerController())
+
+    // The initial chunks are requested once the startup snapshot is read, or known to be missing
+    if (StartupSnapshotLoad.IsValid() && StartupSnapshotLoad.IsReady())
     {
-        if (APawn* Pawn = PC->GetPawn())
+        const FTerrainSnapshotPtr Snapshot = StartupSnapshotLoad.Get();
+        StartupSnapshotLoad = TFuture<FTerrainSnapshotPtr>();
+        RequestInitialChunks(Snapshot);
+    }
+
+    AverageFrameTimeMs = FMath::Lerp(AverageFrameTimeMs, DeltaTime * 1000.0f, 0.1f);
+    const double Deadline = StreamingSettings.bUseFrameBudget
+        ? FPlatformTime::Seconds() + GetFrameBudgetSeconds()
+        : TNumericLimits<double>::Max();
+
+    if (bInitialChunksGenerated)
+    {
+        // A ring width lowered by the memory budget moves every LOD boundary of the window
+        if (bMemoryBudgetLODChanged)
         {
-            FVector pos = FVector(
-                FMath::Floor(Pawn->GetActorLocation().X / ((ChunkSize - 1.0f) * 100)),
-                FMath::Floor(Pawn->GetActorLocation().Y / ((ChunkSize - 1.0f) * 100)),
-                0.0f);
+            bMemoryBudgetLODChanged = false;
+            UpdateGenerationQueue();
+        }
 
-            if (!PlayerPos.Equals(pos))
+        if (APlayerController* PC = GetWorld()->GetFirstPlayerController())
+        {
+            if (APawn* Pawn = PC->GetPawn())
             {
-                PlayerPos = pos;
-                // Queue new chunks generation
-                for (int y = PlayerPos.Y - RenderDistance; y <= PlayerPos.Y + RenderDistance; y++)
+                FVector pos = FVector(
+                    FMath::Floor(Pawn->GetActorLocation().X / ((ChunkSize - 1.0f) * 100)),
+                    FMath::Floor(Pawn->GetActorLocation().Y / ((ChunkSize - 1.0f) * 100)),
+                    0.0f);
+
+                const FVector Velocity = Pawn->GetVelocity();
+                PlayerVelocity = FVector2D(Velocity.X, Velocity.Y) / ((ChunkSize - 1.0f) * 100);
+                TimeSinceLastPrefetch += DeltaTime;
+
+                const bool bMoved = !PlayerPos.Equals(pos);
+                if (bMoved)
                 {
-                    for (int x = PlayerPos.X - RenderDistance; x <= PlayerPos.X + RenderDistance; x++)
-                    {
-                        if (!TerrainGenerator->HasChunk(ChunkData::GetChunkIdFromCoordinates(x * (ChunkSize - 1), y * (ChunkSize - 1))))
-                        {
-                            ChunkGenerationQueue.Enqueue(FVector2D(x, y));
-                        }
-                    }
-                }
+                    PlayerPos = pos;
+                    const FVector ViewDirection = PC->GetControlRotation().Vector();
+                    PlayerViewDirection = FVector2D(ViewDirection.X, ViewDirection.Y).GetSafeNormal();
 
-                // Queue far chunks for destruction
-                int32 playerQuadX = FMath::RoundToInt(PlayerPos.X * (ChunkSize - 1));
-                int32 playerQuadY = FMath::RoundToInt(PlayerPos.Y * (ChunkSize - 1));
+                    UpdateStreamingWindow();
+                    UpdateCollisionWindow();
+                }
 
-                if (TerrainGenerator)
+                if (StreamingSettings.bEnablePrefetch && (bMoved || TimeSinceLastPrefetch >= PrefetchInterval))
                 {
-                    for (auto& [id, chunk] : TerrainGenerator->ChunkMap)
-                    {
-                        int32 chunkX = FMath::RoundToInt(chunk.Coords.X);
-                        int32 chunkY = FMath::RoundToInt(chunk.Coords.Y);
-
-                        if (FMath::Abs(chunkX - playerQuadX) > RenderDistance * (ChunkSize - 1) ||
-                            FMath::Abs(chunkY - playerQuadY) > RenderDistance * (ChunkSize - 1))
-                        {
-                            ChunkDestructionQueue.Enqueue(id);
-                        }
-                    }
+                    UpdatePrefetch();
                 }
             }
         }
+
+        if (StreamingSettings.bUseFrameBudget)
+        {
+            DispatchChunkGenerationBatch();
+        }
+    }
+
+    // Integrate chunks finished by the workers
+    TerrainGenerator->ProcessCompletedChunks(Deadline);
+
+    SET_DWORD_STAT(STAT_PTG_LoadedChunks, TerrainGenerator->ChunkMap.Num());
+    SET_DWORD_STAT(STAT_PTG_GenerationRequests, ChunkGenerationQueue.Num());
+    SET_DWORD_STAT(STAT_PTG_PendingChunks, TerrainGenerator->GetPendingChunkCount());
+    SET_DWORD_STAT(STAT_PTG_QueuedJobs, TerrainGenerator->GetQueuedJobCount());
+    SET_DWORD_STAT(STAT_PTG_InFlightJobs, TerrainGenerator->GetInFlightJobCount());
+    SET_DWORD_STAT(STAT_PTG_LODRingWidth, GetLODRingWidth());
+    SET_MEMORY_STAT(STAT_PTG_HeightMemory, TerrainGenerator->GetResidentMemory().HeightBytes);
+    SET_MEMORY_STAT(STAT_PTG_MeshMemory, TerrainGenerator->GetResidentMemory().MeshBytes);
+    SET_MEMORY_STAT(STAT_PTG_CollisionMemory, TerrainGenerator->GetResidentMemory().CollisionBytes);
+    SET_MEMORY_STAT(STAT_PTG_PooledMeshMemory, TerrainGenerator->GetPooledMeshMemory());
+    SET_MEMORY_STAT(STAT_PTG_PendingMemory, TerrainGenerator->GetPendingMemoryEstimate());
+    SET_MEMORY_STAT(STAT_PTG_SharedMemory, TerrainGenerator->GetContainerMemory() + (MeshGenerator ? MeshGenerator->GetTopologyMemory() : 0));
+    SET_MEMORY_STAT(STAT_PTG_MemoryBudget, GetMemoryBudgetBytes());
+
+    if (!bInitialChunksGenerated)
+    {
+        return;
+    }
+
+    if (StreamingSettings.bUseFrameBudget)
+    {
+        while (FPlatformTime::Seconds() < Deadline && DestroyNextChunk())
+        {
+        }
+        return;
     }
 
     // Process queued operations
     TimeSinceLastChunkOperation += DeltaTime;
     
-    if (TimeSinceLastChunkOperation >= ChunkOperationInterval)
+    if (TimeSinceLastChunkOperation >= StreamingSettings.ChunkOperationInterval)
     {
         TimeSinceLastChunkOperation = 0.0f;
 
-        // Process one chunk generation
-        FVector2D ChunkPos;
-        if (ChunkGenerationQueue.Dequeue(ChunkPos))
+        // Process the nearest chunk generation, held back while it does not fit the memory budget
+        FChunkRequest Request;
+        uint64 ReservedBytes = 0;
+        if (PopChunkRequest(Request))
         {
-            RequestChunkGeneration(
-                ChunkPos.X * (ChunkSize - 1),
-                ChunkPos.Y * (ChunkSize - 1),
-                ChunkSize
-            );
+            if (ReserveChunkMemory(Request, ReservedBytes))
+            {
+                TrackChunk(Request.Coords);
+                RequestChunkGeneration(
+                    Request.Coords.X * (ChunkSize - 1),
+                    Request.Coords.Y * (ChunkSize - 1),
+                    ChunkSize,
+                    Request.Priority,
+                    Request.LOD
+                );
+            }
+            else if (!Request.bPrefetch)
+            {
+                ChunkGenerationQueue.HeapPush(Request);
+            }
         }
 
         // Process one chunk destruction
-        int64 ChunkId;
-        if (ChunkDestructionQueue.Dequeue(ChunkId))
-        {
-            RequestChunkDestruction(ChunkId);
-        }
+        DestroyNextChunk();
     }
 }
 
+/**
+ * @brief Sends queued generation requests to the workers in a single batch
+ * @details Tops the workers up to MaxPendingChunksPerWorker requests each, nearest chunks first.
+ *          The batch stops at the first request that does not fit the memory budget, it stays queued
+ */
+void UChunkManagerWorldSubsystem::DispatchChunkGenerationBatch()
+{
+	const int32 MaxPendingChunks = TerrainGenerator->GetNumWorkers() * StreamingSettings.MaxPendingChunksPerWorker;
+	const int32 BatchSize = MaxPendingChunks - TerrainGenerator->GetPendingChunkCount();
+
+	TArray<FChunkGenerationRequest, TInlineAllocator<32>> Batch;
+	FChunkRequest Request;
+	uint64 ReservedBytes = 0;
+	while (Batch.Num() < BatchSize && PopChunkRequest(Request))
+	{
+		if (!ReserveChunkMemory(Request, ReservedBytes))
+		{
+			// Prefetch requests are dropped, the next prefetch update queues them again
+			if (!Request.bPrefetch)
+			{
+				ChunkGenerationQueue.HeapPush(Request);
+			}
+			break;
+		}
+
+		Batch.Add({ Request.Coords.X * (ChunkSize - 1), Request.Coords.Y * (ChunkSize - 1), Request.Priority, Request.LOD });
+		TrackChunk(Request.Coords);
+	}
+
+	if (Batch.Num() > 0)
+	{
+		TerrainGenerator->GenerateChunks(Batch, ChunkSize, TerrainParameters, BiomesParameters);
+	}
+}
+
+/**
+ * @brief Pops the highest priority request that still needs generating
+ * @param OutRequest Popped request
+ * @return False once the queue is empty
+ * @details Requests for chunks already generated or being generated at the requested LOD with the current parameters are skipped
+ */
+bool UChunkManagerWorldSubsystem::PopChunkRequest(FChunkRequest& OutRequest)
+{
+	while (ChunkGenerationQueue.Num() > 0)
+	{
+		ChunkGenerationQueue.HeapPop(OutRequest, EAllowShrinking::No);
+
+		if (!IsChunkRequested(OutRequest.Coords, OutRequest.LOD))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Destroys the next queued chunk, skipping chunks the player came back to
+ * @return False once the destruction queue is empty
+ */
+bool UChunkManagerWorldSubsystem::DestroyNextChunk()
+{
+	int64 ChunkId;
+	while (ChunkDestructionQueue.Dequeue(ChunkId))
+	{
+		const FChunk* Chunk = TerrainGenerator->GetChunk(ChunkId);
+		if (Chunk && !IsChunkInRange(*Chunk))
+		{
+			RequestChunkDestruction(ChunkId);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Computes the game thread time streaming may use this frame
+ * @return Budget in seconds
+ * @details Half of the headroom below TargetFrameTimeMs is added to FrameBudgetMs, up to MaxFrameBudgetMs.
+ *          The initial generation runs with the maximum budget as the player is waiting for it
+ */
+double UChunkManagerWorldSubsystem::GetFrameBudgetSeconds() const
+{
+	if (!bInitialChunksGenerated)
+	{
+		return StreamingSettings.MaxFrameBudgetMs / 1000.0;
+	}
+
+	const float HeadroomMs = FMath::Max(0.0f, StreamingSettings.TargetFrameTimeMs - AverageFrameTimeMs);
+	return FMath::Min(StreamingSettings.FrameBudgetMs + HeadroomMs * 0.5f, StreamingSettings.MaxFrameBudgetMs) / 1000.0;
+}
+
+/**
+ * @brief Moves the render window to the current player position
+ * @details A move of up to RenderDistance chunks only visits the rows and columns leaving and entering the window,
+ *          and the rings where the LOD changes. Larger moves and render distance changes rebuild everything
+ */
+void UChunkManagerWorldSubsystem::UpdateStreamingWindow()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UChunkManagerWorldSubsystem::UpdateStreamingWindow);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_UpdateStreaming);
+
+	if (!TerrainGenerator)
+	{
+		return;
+	}
+
+	const FIntPoint Center(FMath::RoundToInt(PlayerPos.X), FMath::RoundToInt(PlayerPos.Y));
+	const FIntPoint Delta = Center - ChunkGrid.GetCenter();
+	TArray<int64> ExitedChunks;
+	TArray<FIntPoint> EnteredCells;
+
+	if (ChunkGrid.GetRadius() != RenderDistance || !ChunkGrid.Move(Center, ExitedChunks, EnteredCells))
+	{
+		UpdateGenerationQueue();
+		UpdateChunkDestruction();
+		return;
+	}
+
+	// Chunks still being generated hold no mesh yet and are cancelled right away
+	for (int64 ChunkId : ExitedChunks)
+	{
+		if (TerrainGenerator->IsChunkPending(ChunkId))
+		{
+			RequestChunkDestruction(ChunkId);
+		}
+		else if (TerrainGenerator->HasChunk(ChunkId))
+		{
+			ChunkDestructionQueue.Enqueue(ChunkId);
+		}
+	}
+
+	// Pending requests are scored again for the new position, those that left the window are dropped.
+	// Prefetch requests stay queued behind the window ones until they fall out of the prefetch range, those the window
+	// reached are queued again below as window requests
+	const int32 KeepDistance = RenderDistance + StreamingSettings.MaxPrefetchDistance;
+	for (int32 i = ChunkGenerationQueue.Num() - 1; i >= 0; i--)
+	{
+		FChunkRequest& Request = ChunkGenerationQueue[i];
+		if (Request.bPrefetch)
+		{
+			const FIntPoint Offset = Request.Coords - Center;
+			if (ChunkGrid.Contains(Request.Coords) || FMath::Max(FMath::Abs(Offset.X), FMath::Abs(Offset.Y)) > KeepDistance)
+			{
+				ChunkGenerationQueue.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			}
+			else
+			{
+				Request.Priority = PrefetchPriorityBias + FVector2D(Request.Coords.X - PlayerPos.X, Request.Coords.Y - PlayerPos.Y).Size();
+			}
+			continue;
+		}
+		if (!ChunkGrid.Contains(Request.Coords))
+		{
+			ChunkGenerationQueue.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+		Request.Priority = GetChunkPriority(Request.Coords.X, Request.Coords.Y);
+		Request.LOD = GetChunkLOD(Request.Coords.X, Request.Coords.Y);
+	}
+
+	// Entered cells may already hold a chunk, prefetched or not destroyed yet
+	for (const FIntPoint& Cell : EnteredCells)
+	{
+		if (TerrainGenerator->HasChunk(ChunkData::GetChunkIdFromCoordinates(Cell.X * (ChunkSize - 1), Cell.Y * (ChunkSize - 1))))
+		{
+			TrackChunk(Cell);
+		}
+		QueueChunkIfNeeded(Cell);
+	}
+
+	// Distances change by at most the move, so LODs only change in the rings around each LOD boundary
+	if (StreamingSettings.bEnableLOD)
+	{
+		const int32 Moved = FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y));
+		const int32 RingWidth = GetLODRingWidth();
+
+		for (int32 LOD = 1; LOD <= StreamingSettings.MaxLOD; LOD++)
+		{
+			const int32 Boundary = LOD * RingWidth;
+			for (int32 Ring = FMath::Max(Boundary - Moved, 0); Ring < Boundary + Moved && Ring <= RenderDistance; Ring++)
+			{
+				for (int32 i = -Ring; i <= Ring; i++)
+				{
+					QueueChunkIfNeeded(Center + FIntPoint(i, -Ring));
+					QueueChunkIfNeeded(Center + FIntPoint(i, Ring));
+					if (i != -Ring && i != Ring)
+					{
+						QueueChunkIfNeeded(Center + FIntPoint(-Ring, i));
+						QueueChunkIfNeeded(Center + FIntPoint(Ring, i));
+					}
+				}
+			}
+		}
+	}
+
+	ChunkGenerationQueue.Heapify();
+}
+
+/**
+ * @brief Queues a cell of the render window whose chunk is missing, at another LOD or out of date
+ * @param Cell Cell in chunk space
+ */
+void UChunkManagerWorldSubsystem::QueueChunkIfNeeded(const FIntPoint& Cell)
+{
+	const int32 LOD = GetChunkLOD(Cell.X, Cell.Y);
+	if (!IsChunkRequested(Cell, LOD))
+	{
+		ChunkGenerationQueue.Add({ Cell, GetChunkPriority(Cell.X, Cell.Y), LOD });
+	}
+}
+
+/**
+ * @brief Records a requested chunk in the render window index
+ * @param Cell Cell in chunk space
+ * @details Chunks requested outside the window are prefetched ones
+ */
+void UChunkManagerWorldSubsystem::TrackChunk(const FIntPoint& Cell)
+{
+	const int64 ChunkId = ChunkData::GetChunkIdFromCoordinates(Cell.X * (ChunkSize - 1), Cell.Y * (ChunkSize - 1));
+	if (ChunkGrid.Contains(Cell))
+	{
+		ChunkGrid.SetChunk(Cell, ChunkId);
+	}
+	else
+	{
+		PrefetchedChunks.Add(ChunkId);
+	}
+}
+
+/**
+ * @brief Queues the chunks the player is heading to, beyond the render window
+ * @details The lookahead covers PrefetchLookaheadSeconds of travel at the current velocity, up to MaxPrefetchDistance chunks,
+ *          and shrinks with the share of busy workers so prefetching never competes with the window. Cells entering the window
+ *          around each projected chunk of the path are requested at the LOD of the window edge, after every window request.
+ *          Each step only visits the strip of cells it adds to the window of the previous one.
+ *          Prefetch requests still queued from the previous update are replaced
+ */
+void UChunkManagerWorldSubsystem::UpdatePrefetch()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UChunkManagerWorldSubsystem::UpdatePrefetch);
+
+	TimeSinceLastPrefetch = 0.0f;
+	ChunkGenerationQueue.RemoveAllSwap([](const FChunkRequest& Request) { return Request.bPrefetch; }, EAllowShrinking::No);
+	ReleasePrefetchedChunks();
+
+	const int32 MaxPendingChunks = FMath::Max(TerrainGenerator->GetNumWorkers() * StreamingSettings.MaxPendingChunksPerWorker, 1);
+	const float IdleShare = FMath::Clamp(1.0f - (float)TerrainGenerator->GetPendingChunkCount() / MaxPendingChunks, 0.0f, 1.0f);
+	const float Speed = PlayerVelocity.Size();
+	const int32 Lookahead = FMath::Min(FMath::CeilToInt(Speed * StreamingSettings.PrefetchLookaheadSeconds * IdleShare), StreamingSettings.MaxPrefetchDistance);
+
+	if (Lookahead > 0 && ChunkGrid.IsValid())
+	{
+		const FVector2D Direction = PlayerVelocity / Speed;
+		const int32 LOD = ChunkData::GetRingLOD(RenderDistance, ChunkSize, StreamingSettings, GetLODRingWidth());
+
+		// The path goes one way, so a cell left behind by a step is never entered again by a later one
+		TArray<FChunkRequest> Candidates;
+		TArray<FIntPoint> EnteredCells;
+		FIntPoint Previous = ChunkGrid.GetCenter();
+		for (int32 Step = 1; Step <= Lookahead; Step++)
+		{
+			const FIntPoint Projected(FMath::RoundToInt(PlayerPos.X + Direction.X * Step), FMath::RoundToInt(PlayerPos.Y + Direction.Y * Step));
+			EnteredCells.Reset();
+			FChunkRingGrid::GetEnteredCells(RenderDistance, Previous, Projected, EnteredCells);
+			Previous = Projected;
+
+			for (const FIntPoint& Cell : EnteredCells)
+			{
+				if (ChunkGrid.Contains(Cell) || IsChunkRequested(Cell, LOD))
+				{
+					continue;
+				}
+				Candidates.Add({ Cell, PrefetchPriorityBias + FVector2D(Cell.X - PlayerPos.X, Cell.Y - PlayerPos.Y).Size(), LOD, true });
+			}
+		}
+
+		Candidates.Sort();
+		for (int32 i = 0; i < FMath::Min(Candidates.Num(), StreamingSettings.MaxPrefetchChunks); i++)
+		{
+			ChunkGenerationQueue.Add(Candidates[i]);
+		}
+	}
+
+	ChunkGenerationQueue.Heapify();
+}
+
+/**
+ * @brief Forgets prefetched chunks the render window reached and destroys those the player turned away from
+ * @details Chunks farther than MaxPrefetchDistance beyond the window are destroyed right away, they hold no collision
+ */
+void UChunkManagerWorldSubsystem::ReleasePrefetchedChunks()
+{
+	const FIntPoint Center = ChunkGrid.GetCenter();
+	const int32 KeepDistance = RenderDistance + StreamingSettings.MaxPrefetchDistance;
+
+	for (auto It = PrefetchedChunks.CreateIterator(); It; ++It)
+	{
+		const FChunk* Chunk = TerrainGenerator->GetChunk(*It);
+		if (!Chunk || ChunkGrid.Contains(Chunk->GetCell()))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		const FIntPoint Offset = Chunk->GetCell() - Center;
+		if (FMath::Max(FMath::Abs(Offset.X), FMath::Abs(Offset.Y)) > KeepDistance || !StreamingSettings.bEnablePrefetch)
+		{
+			RequestChunkDestruction(*It);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+/**
+ * @brief Picks the width of the LOD rings the render window fits the memory budget with
+ * @return True if the ring width changed
+ * @details The widest rings up to LODRingWidth whose estimated window fits are used. Without LOD, or when rings one chunk
+ *          wide still do not fit, the window streams in until the budget is reached and its farthest chunks are held back
+ */
+bool UChunkManagerWorldSubsystem::UpdateMemoryBudget()
+{
+	const int32 PreviousRingWidth = GetLODRingWidth();
+	const uint64 Budget = GetMemoryBudgetBytes();
+	BudgetLODRingWidth = 0;
+	bMemoryBudgetExceeded = false;
+
+	if (Budget == 0)
+	{
+		return GetLODRingWidth() != PreviousRingWidth;
+	}
+
+	int32 RingWidth = GetLODRingWidth();
+	if (StreamingSettings.bEnableLOD)
+	{
+		while (RingWidth > 1 && EstimateWindowMemory(RingWidth) > Budget)
+		{
+			RingWidth--;
+		}
+	}
+	BudgetLODRingWidth = RingWidth;
+
+	const uint64 WindowBytes = EstimateWindowMemory(RingWidth);
+	if (WindowBytes > Budget)
+	{
+		UE_LOG(LogPTG, Warning, TEXT("Render window needs an estimated %.1f MB, over the %d MB terrain memory budget, its farthest chunks are held back"),
+			WindowBytes / (1024.0 * 1024.0), StreamingSettings.MemoryBudgetMB);
+	}
+	else if (RingWidth < StreamingSettings.LODRingWidth)
+	{
+		UE_LOG(LogPTG, Log, TEXT("LOD rings narrowed to %d chunks to fit the %d MB terrain memory budget, window estimated at %.1f MB"),
+			RingWidth, StreamingSettings.MemoryBudgetMB, WindowBytes / (1024.0 * 1024.0));
+	}
+
+	return RingWidth != PreviousRingWidth;
+}
+
+/**
+ * @brief Makes room for a generation request in the memory budget
+ * @param Request Request about to be dispatched
+ * @param InOutReservedBytes Bytes reserved by the requests dispatched along with it, increased on success
+ * @return True if the request fits, possibly after evicting chunks
+ * @details Chunks that left the window are destroyed first, then prefetched chunks for window requests, then the sections
+ *          kept by pooled mesh actors, destroyed chunks refilling the pool. A chunk replaced by a lighter one, a coarser LOD
+ *          for instance, always fits. When nothing can be evicted and no generation in flight will free memory,
+ *          the LOD rings are narrowed by one chunk
+ */
+bool UChunkManagerWorldSubsystem::ReserveChunkMemory(const FChunkRequest& Request, uint64& InOutReservedBytes)
+{
+	const uint64 Budget = GetMemoryBudgetBytes();
+	if (Budget == 0 || !TerrainGenerator)
+	{
+		return true;
+	}
+
+	const FIntPoint Offset = Request.Coords - ChunkGrid.GetCenter();
+	const bool bCollision = !Request.bPrefetch && FMath::Max(FMath::Abs(Offset.X), FMath::Abs(Offset.Y)) <= FMath::Min(StreamingSettings.CollisionRadius, RenderDistance);
+	const bool bSkirts = StreamingSettings.bEnableLOD && StreamingSettings.SkirtDepth > 0.0f;
+	const uint64 Estimate = UProceduralMeshGeneratorSubsystem::EstimateChunkMemory(ChunkSize, Request.LOD, bSkirts, bCollision ? StreamingSettings.CollisionLOD : INDEX_NONE).GetTotal();
+
+	const int64 ChunkId = ChunkData::GetChunkIdFromCoordinates(Request.Coords.X * (ChunkSize - 1), Request.Coords.Y * (ChunkSize - 1));
+	const uint64 ExistingBytes = TerrainGenerator->GetChunkMemory(ChunkId).GetTotal();
+	if (Estimate <= ExistingBytes)
+	{
+		return true;
+	}
+
+	const uint64 Needed = InOutReservedBytes + Estimate - ExistingBytes;
+	auto Fits = [this, Budget, Needed]() { return GetTerrainMemory() + Needed <= Budget; };
+
+	while (!Fits() && DestroyNextChunk())
+	{
+	}
+
+	if (!Fits() && !Request.bPrefetch)
+	{
+		for (auto It = PrefetchedChunks.CreateIterator(); It && !Fits(); ++It)
+		{
+			RequestChunkDestruction(*It);
+			It.RemoveCurrent();
+		}
+	}
+
+	if (!Fits() && TerrainGenerator->GetPooledMeshActorCount() > 0)
+	{
+		TerrainGenerator->EmptyMeshActorPool();
+	}
+
+	if (Fits())
+	{
+		InOutReservedBytes += Estimate - ExistingBytes;
+
+		// Warned again once usage fell well below the budget and reached it a second time
+		if (bMemoryBudgetExceeded && GetTerrainMemory() + InOutReservedBytes < Budget / 10 * 9)
+		{
+			bMemoryBudgetExceeded = false;
+		}
+		return true;
+	}
+
+	if (!bMemoryBudgetExceeded)
+	{
+		bMemoryBudgetExceeded = true;
+		UE_LOG(LogPTG, Warning, TEXT("Terrain memory budget of %d MB reached at %.1f MB, streaming is held back"),
+			StreamingSettings.MemoryBudgetMB, GetTerrainMemory() / (1024.0 * 1024.0));
+	}
+
+	// Only rings of the window get coarser, once the generations in flight no longer free memory
+	if (!Request.bPrefetch && StreamingSettings.bEnableLOD && GetLODRingWidth() > 1 && !bMemoryBudgetLODChanged
+		&& InOutReservedBytes == 0 && TerrainGenerator->GetPendingChunkCount() == 0)
+	{
+		BudgetLODRingWidth = GetLODRingWidth() - 1;
+		bMemoryBudgetLODChanged = true;
+		UE_LOG(LogPTG, Log, TEXT("LOD rings narrowed to %d chunks to stay within the terrain memory budget"), BudgetLODRingWidth);
+	}
+	return false;
+}
+
+/**
+ * @brief Estimates the memory of a complete render window
+ * @param RingWidth Width of the LOD rings
+ * @return Bytes of the chunks of every ring at their LOD, collision included within CollisionRadius
+ */
+uint64 UChunkManagerWorldSubsystem::EstimateWindowMemory(int32 RingWidth) const
+{
+	const bool bSkirts = StreamingSettings.bEnableLOD && StreamingSettings.SkirtDepth > 0.0f;
+	const int32 CollisionRadius = FMath::Min(StreamingSettings.CollisionRadius, RenderDistance);
+
+	uint64 Bytes = 0;
+	for (int32 Ring = 0; Ring <= RenderDistance; Ring++)
+	{
+		const uint64 NumChunks = Ring == 0 ? 1 : 8 * Ring;
+		const int32 LOD = ChunkData::GetRingLOD(Ring, ChunkSize, StreamingSettings, RingWidth);
+		const int32 RingCollisionLOD = Ring <= CollisionRadius ? StreamingSettings.CollisionLOD : INDEX_NONE;
+		Bytes += NumChunks * UProceduralMeshGeneratorSubsystem::EstimateChunkMemory(ChunkSize, LOD, bSkirts, RingCollisionLOD).GetTotal();
+	}
+	return Bytes;
+}
+
+/**
+ * @brief Returns the memory held by the terrain
+ * @return Measured bytes of the chunks, pooled meshes, topologies and containers, plus the estimate of the pending generations
+ */
+uint64 UChunkManagerWorldSubsystem::GetTerrainMemory() const
+{
+	if (!TerrainGenerator)
+	{
+		return 0;
+	}
+
+	return TerrainGenerator->GetResidentMemory().GetTotal() + TerrainGenerator->GetPooledMeshMemory() + TerrainGenerator->GetPendingMemoryEstimate()
+		+ TerrainGenerator->GetContainerMemory() + (MeshGenerator ? MeshGenerator->GetTopologyMemory() : 0);
+}
+
+/**
+ * @brief Logs the terrain memory by category and by LOD, also run by the PTG.MemoryReport console command
+ */
+void UChunkManagerWorldSubsystem::LogMemoryReport() const
+{
+	if (!TerrainGenerator)
+	{
+		return;
+	}
+
+	auto ToMB = [](uint64 Bytes) { return Bytes / (1024.0 * 1024.0); };
+	const FChunkMemoryUsage& Resident = TerrainGenerator->GetResidentMemory();
+	const FString BudgetText = GetMemoryBudgetBytes() > 0 ? FString::Printf(TEXT("%d MB"), StreamingSettings.MemoryBudgetMB) : FString(TEXT("disabled"));
+
+	UE_LOG(LogPTG, Display, TEXT("Terrain memory: %.1f MB, budget %s"), ToMB(GetTerrainMemory()), *BudgetText);
+	UE_LOG(LogPTG, Display, TEXT("  Heights: %.1f MB"), ToMB(Resident.HeightBytes));
+	UE_LOG(LogPTG, Display, TEXT("  Meshes: %.1f MB"), ToMB(Resident.MeshBytes));
+	UE_LOG(LogPTG, Display, TEXT("  Collision: %.1f MB"), ToMB(Resident.CollisionBytes));
+	UE_LOG(LogPTG, Display, TEXT("  Pooled meshes: %.1f MB in %d actors"), ToMB(TerrainGenerator->GetPooledMeshMemory()), TerrainGenerator->GetPooledMeshActorCount());
+	UE_LOG(LogPTG, Display, TEXT("  Pending chunks: %.1f MB estimated for %d jobs"), ToMB(TerrainGenerator->GetPendingMemoryEstimate()), TerrainGenerator->GetPendingChunkCount());
+	UE_LOG(LogPTG, Display, TEXT("  Topologies and containers: %.1f MB"), ToMB(TerrainGenerator->GetContainerMemory() + (MeshGenerator ? MeshGenerator->GetTopologyMemory() : 0)));
+	UE_LOG(LogPTG, Display, TEXT("  LOD rings: %d chunks wide of %d, window estimated at %.1f MB"), GetLODRingWidth(), StreamingSettings.LODRingWidth,
+		ToMB(EstimateWindowMemory(GetLODRingWidth())));
+
+	TArray<int32> ChunksPerLOD;
+	TArray<uint64> BytesPerLOD;
+	for (const auto& [Id, Chunk] : TerrainGenerator->ChunkMap)
+	{
+		if (Chunk.LOD >= ChunksPerLOD.Num())
+		{
+			ChunksPerLOD.SetNumZeroed(Chunk.LOD + 1);
+			BytesPerLOD.SetNumZeroed(Chunk.LOD + 1);
+		}
+		ChunksPerLOD[Chunk.LOD]++;
+		BytesPerLOD[Chunk.LOD] += TerrainGenerator->GetChunkMemory(Id).GetTotal();
+	}
+
+	for (int32 LOD = 0; LOD < ChunksPerLOD.Num(); LOD++)
+	{
+		UE_LOG(LogPTG, Display, TEXT("  LOD %d: %d chunks, %.1f MB"), LOD, ChunksPerLOD[LOD], ToMB(BytesPerLOD[LOD]));
+	}
+}
+
+/**
+ * @brief Rebuilds the generation queue and the render window index around the current player position
+ * @details Missing chunks of the render window are queued nearest first, biased towards the view direction.
+ *          Chunks whose LOD no longer matches their distance or generated with other parameters are queued again.
+ *          Requests queued for a previous position are dropped, so chunks that left the render radius are never started
+ */
+void UChunkManagerWorldSubsystem::UpdateGenerationQueue()
+{
+	ChunkGenerationQueue.Reset();
+
+	if (!TerrainGenerator)
+	{
+		return;
+	}
+
+	ChunkGrid.Reset(RenderDistance, FIntPoint(FMath::RoundToInt(PlayerPos.X), FMath::RoundToInt(PlayerPos.Y)));
+
+	for (int y = PlayerPos.Y - RenderDistance; y <= PlayerPos.Y + RenderDistance; y++)
+	{
+		for (int x = PlayerPos.X - RenderDistance; x <= PlayerPos.X + RenderDistance; x++)
+		{
+			if (TerrainGenerator->HasChunk(ChunkData::GetChunkIdFromCoordinates(x * (ChunkSize - 1), y * (ChunkSize - 1))))
+			{
+				TrackChunk(FIntPoint(x, y));
+			}
+			QueueChunkIfNeeded(FIntPoint(x, y));
+		}
+	}
+
+	ChunkGenerationQueue.Heapify();
+}
+
+/**
+ * @brief Handles chunks that are out of the render window
+ * @details Chunks still being generated are cancelled right away as they hold no mesh yet,
+ *          displayed chunks are queued for throttled destruction. Scans every loaded chunk, only used when the window is rebuilt
+ */
+void UChunkManagerWorldSubsystem::UpdateChunkDestruction()
+{
+	if (!TerrainGenerator)
+	{
+		return;
+	}
+
+	TArray<int64> CancelledChunks;
+	for (auto& [id, chunk] : TerrainGenerator->ChunkMap)
+	{
+		if (!IsChunkInRange(chunk))
+		{
+			if (TerrainGenerator->IsChunkPending(id))
+			{
+				CancelledChunks.Add(id);
+			}
+			else
+			{
+				ChunkDestructionQueue.Enqueue(id);
+			}
+		}
+	}
+
+	for (int64 id : CancelledChunks)
+	{
+		RequestChunkDestruction(id);
+	}
+}
+
+/**
+ * @brief Moves the collision window to the current player position
+ * @details Chunks within CollisionRadius rings of the player chunk cook collision, those that left the window drop it.
+ *          Only the cells of the previous and current windows are visited
+ */
+void UChunkManagerWorldSubsystem::UpdateCollisionWindow()
+{
+	if (!TerrainGenerator)
+	{
+		return;
+	}
+
+	const FIntPoint Center(FMath::RoundToInt(PlayerPos.X), FMath::RoundToInt(PlayerPos.Y));
+	const int32 Radius = FMath::Min(StreamingSettings.CollisionRadius, RenderDistance);
+	if (Center == CollisionCenter && Radius == CollisionWindowRadius)
+	{
+		return;
+	}
+
+	auto GetCellChunkId = [this](int32 X, int32 Y) { return ChunkData::GetChunkIdFromCoordinates(X * (ChunkSize - 1), Y * (ChunkSize - 1)); };
+
+	for (int32 y = CollisionCenter.Y - CollisionWindowRadius; y <= CollisionCenter.Y + CollisionWindowRadius; y++)
+	{
+		for (int32 x = CollisionCenter.X - CollisionWindowRadius; x <= CollisionCenter.X + CollisionWindowRadius; x++)
+		{
+			if (FMath::Max(FMath::Abs(x - Center.X), FMath::Abs(y - Center.Y)) > Radius)
+			{
+				TerrainGenerator->SetChunkCollision(GetCellChunkId(x, y), false);
+			}
+		}
+	}
+
+	for (int32 y = Center.Y - Radius; y <= Center.Y + Radius; y++)
+	{
+		for (int32 x = Center.X - Radius; x <= Center.X + Radius; x++)
+		{
+			TerrainGenerator->SetChunkCollision(GetCellChunkId(x, y), true);
+		}
+	}
+
+	CollisionCenter = Center;
+	CollisionWindowRadius = Radius;
+}
+
+/**
+ * @brief Computes the generation priority of a chunk
+ * @param X Chunk X-coordinate in chunk space
+ * @param Y Chunk Y-coordinate in chunk space
+ * @return Distance to the player, scaled up to (1 + ViewDirectionWeight) for chunks behind the view direction
+ */
+float UChunkManagerWorldSubsystem::GetChunkPriority(int32 X, int32 Y) const
+{
+	const FVector2D Offset(X - PlayerPos.X, Y - PlayerPos.Y);
+	const float Distance = Offset.Size();
+
+	if (Distance <= 0.0f || PlayerViewDirection.IsNearlyZero())
+	{
+		return Distance;
+	}
+
+	const float Facing = FVector2D::DotProduct(Offset / Distance, PlayerViewDirection);
+	return Distance * (1.0f + ViewDirectionWeight * (1.0f - Facing) * 0.5f);
+}
+
+/**
+ * @brief Computes the level of detail a chunk should be generated at
+ * @param X Chunk X-coordinate in chunk space
+ * @param Y Chunk Y-coordinate in chunk space
+ * @return LOD of the ring of the chunk around the player chunk, see ChunkData::GetRingLOD. Rings may be narrower than
+ *         LODRingWidth to fit the memory budget
+ */
+int32 UChunkManagerWorldSubsystem::GetChunkLOD(int32 X, int32 Y) const
+{
+	const int32 Ring = FMath::Max(FMath::Abs(X - FMath::RoundToInt(PlayerPos.X)), FMath::Abs(Y - FMath::RoundToInt(PlayerPos.Y)));
+	return ChunkData::GetRingLOD(Ring, ChunkSize, StreamingSettings, GetLODRingWidth());
+}
+
+/**
+ * @brief Checks whether the chunk of a cell is generated or being generated as wanted
+ * @param Cell Cell in chunk space
+ * @param LOD Wanted level of detail
+ * @return True if the chunk is, or will be, at this LOD and generated with the current parameters
+ */
+bool UChunkManagerWorldSubsystem::IsChunkRequested(const FIntPoint& Cell, int32 LOD) const
+{
+	const int64 ChunkId = ChunkData::GetChunkIdFromCoordinates(Cell.X * (ChunkSize - 1), Cell.Y * (ChunkSize - 1));
+	return TerrainGenerator->GetRequestedChunkLOD(ChunkId) == LOD && TerrainGenerator->GetRequestedChunkParametersHash(ChunkId) == ParametersHash;
+}
+
+/**
+ * @brief Checks whether a chunk lies inside the render window around the player
+ * @param Chunk Chunk to test
+ * @return True if the chunk should stay loaded
+ */
+bool UChunkManagerWorldSubsystem::IsChunkInRange(const FChunk& Chunk) const
+{
+	int32 playerQuadX = FMath::RoundToInt(PlayerPos.X * (ChunkSize - 1));
+	int32 playerQuadY = FMath::RoundToInt(PlayerPos.Y * (ChunkSize - 1));
+	int32 chunkX = FMath::RoundToInt(Chunk.Coords.X);
+	int32 chunkY = FMath::RoundToInt(Chunk.Coords.Y);
+
+	return FMath::Abs(chunkX - playerQuadX) <= RenderDistance * (ChunkSize - 1) &&
+		FMath::Abs(chunkY - playerQuadY) <= RenderDistance * (ChunkSize - 1);
+}
+
 /**
  * @brief Performs stress test of chunk generation
  * @param NumChunks Number of chunks to generate for testing
- * @details Measures performance metrics during bulk chunk generation
+ * @details Measures the end to end time of bulk chunk generation, display included.
+ *          Chunks are laid out along a row beyond the render window around the player without overlapping, and released once the test completes.
+ *          Per stage timings are measured by the PTGBenchmark commandlet
  */
 void UChunkManagerWorldSubsystem::StressTest(int32 NumChunks)
 {
-	PendingChunks = NumChunks;
+	if (NumChunks <= 0 || bStressTestInProgress)
+	{
+		return;
+	}
+
+	StressTestChunkCount = NumChunks;
 	bStressTestInProgress = true;
 	StressTestStartTime = FPlatformTime::Seconds();
     
-	UE_LOG(LogTemp, Warning, TEXT("Starting Stress Test - Generating %d chunks"), NumChunks);
+	UE_LOG(LogPTG, Log, TEXT("Starting Stress Test - Generating %d chunks"), NumChunks);
     
+	const FIntPoint& Center = ChunkGrid.GetCenter();
+	StressTestCells.Reset(NumChunks);
+	PendingStressTestChunks.Reset();
 	for(int32 i = 0; i < NumChunks; i++)
 	{
-		RequestChunkGeneration(i * 31, 0, 32);
+		const FIntPoint Cell(Center.X + RenderDistance + 1 + i, Center.Y);
+		StressTestCells.Add(Cell);
+		PendingStressTestChunks.Add(ChunkData::GetChunkIdFromCoordinates(Cell.X * (ChunkSize - 1), Cell.Y * (ChunkSize - 1)));
+		RequestChunkGeneration(Cell.X * (ChunkSize - 1), Cell.Y * (ChunkSize - 1), ChunkSize);
 	}
 }
 
 /**
- * @brief Initiates generation of initial chunk grid
- * @param InRenderDistance Radius of chunks to generate around player
- * @details Creates initial terrain grid centered on player position
+ * @brief Releases the chunks generated by the stress test
+ * @details Chunks inside the render window are tracked as window chunks, the others are queued for throttled destruction
  */
-void UChunkManagerWorldSubsystem::InitialChunkGeneration(int32 InRenderDistance)
+void UChunkManagerWorldSubsystem::ReleaseStressTestChunks()
 {
-	UE_LOG(LogTemp, Warning, TEXT("Starting InitialChunkGeneration with RenderDistance: %d"), InRenderDistance);
-	InitialChunksRemaining = ChunkData::GetInitialChunkCount(InRenderDistance);
-    
-	RequestChunkGeneration(0, 0, ChunkSize);
+	for (const FIntPoint& Cell : StressTestCells)
+	{
+		const int64 ChunkId = ChunkData::GetChunkIdFromCoordinates(Cell.X * (ChunkSize - 1), Cell.Y * (ChunkSize - 1));
+		if (ChunkGrid.Contains(Cell))
+		{
+			TrackChunk(Cell);
+		}
+		else if (TerrainGenerator && TerrainGenerator->HasChunk(ChunkId))
+		{
+			ChunkDestructionQueue.Enqueue(ChunkId);
+		}
+	}
+	StressTestCells.Empty();
+}
+
+/**
+ * @brief Applies a new noise layer graph
+ * @param Settings Layers stacked on the base height
+ */
+void UChunkManagerWorldSubsystem::SetTerrainLayers(const FTerrainLayerSettings& Settings)
+{
+	TerrainLayers = Settings;
+
+	if (TerrainGenerator)
+	{
+		TerrainGenerator->SetTerrainLayers(TerrainLayers);
+	}
+	OnParametersChanged();
+}
+
+/**
+ * @brief Versions the terrain after a parameter or layer change
+ * @details With bRebuildOnParameterChange the visible terrain is regenerated right away, otherwise out of date
+ *          chunks are only replaced when the render window is rebuilt or RebuildVisibleTerrain is called
+ */
+void UChunkManagerWorldSubsystem::OnParametersChanged()
+{
+	const uint32 NewParametersHash = ChunkData::GetParametersHash(TerrainParameters, BiomesParameters, TerrainLayers, ChunkSize);
+	if (NewParametersHash == ParametersHash)
+	{
+		return;
+	}
+
+	ParametersHash = NewParametersHash;
+	if (StreamingSettings.bRebuildOnParameterChange)
+	{
+		RebuildVisibleTerrain();
+	}
+}
+
+/**
+ * @brief Regenerates the chunks of the render window generated with other parameters
+ * @details Requests go through the regular generation queue, nearest first and within the streaming frame budget.
+ *          Out of date chunks stay displayed and their section is swapped in one upload once the new mesh is built,
+ *          so the terrain never shows holes while it is rebuilt
+ */
+void UChunkManagerWorldSubsystem::RebuildVisibleTerrain()
+{
+	if (!bInitialChunksGenerated || !TerrainGenerator)
+	{
+		return;
+	}
+
+	UE_LOG(LogPTG, Log, TEXT("Rebuilding visible terrain with parameters %08x"), ParametersHash);
+	UpdateGenerationQueue();
+}
 
-	for (int y = -RenderDistance; y <= RenderDistance; y++)
+/**
+ * @brief Applies new streaming settings
+ * @param Settings Streaming and worker settings
+ */
+void UChunkManagerWorldSubsystem::SetStreamingSettings(const FChunkStreamingSettings& Settings)
+{
+	StreamingSettings = Settings;
+	const bool bLODRingsChanged = UpdateMemoryBudget();
+
+	if (TerrainGenerator)
 	{
-		for (int x = -RenderDistance; x <= RenderDistance; x++)
+		TerrainGenerator->ConfigureWorkers(StreamingSettings.NumWorkers, StreamingSettings.WorkerPriority);
+		TerrainGenerator->SetSkirtDepth(StreamingSettings.bEnableLOD ? StreamingSettings.SkirtDepth : 0.0f);
+		TerrainGenerator->ConfigureDiskCache(StreamingSettings.bUseDiskCache, StreamingSettings.bCompressDiskCache);
+		TerrainGenerator->SetGenerationBackend(StreamingSettings.GenerationBackend, StreamingSettings.MaxChunksPerGPUDispatch);
+		TerrainGenerator->SetCollisionLOD(StreamingSettings.CollisionLOD);
+		TerrainGenerator->SetRegionSize(StreamingSettings.RegionSize);
+
+		if (bInitialChunksGenerated)
 		{
-			if (x == 0 && y == 0)
+			UpdateCollisionWindow();
+			if (bLODRingsChanged)
 			{
-				continue;
+				UpdateGenerationQueue();
 			}
-			
-			RequestChunkGeneration(x * (ChunkSize - 1), y * (ChunkSize - 1), ChunkSize);
+			if (!StreamingSettings.bEnablePrefetch)
+			{
+				ChunkGenerationQueue.RemoveAllSwap([](const FChunkRequest& Request) { return Request.bPrefetch; }, EAllowShrinking::No);
+				ChunkGenerationQueue.Heapify();
+				ReleasePrefetchedChunks();
+			}
+		}
+	}
+}
+
+/**
+ * @brief Initiates generation of initial chunk grid
+ * @param InRenderDistance Radius of chunks to generate around player, clamped to the render window
+ * @details Creates initial terrain grid centered on player position, distant rings at a lower LOD when enabled.
+ *          With a startup snapshot the chunks are only requested once it is read on the thread pool
+ */
+void UChunkManagerWorldSubsystem::InitialChunkGeneration(int32 InRenderDistance)
+{
+	UE_LOG(LogPTG, Log, TEXT("Starting InitialChunkGeneration with RenderDistance: %d"), InRenderDistance);
+	InitialGenerationStartTime = FPlatformTime::Seconds();
+	// Rings past the window would be tracked as prefetched chunks and destroyed by the next prefetch update
+	InitialRadius = FMath::Clamp(InRenderDistance, 0, RenderDistance);
+	InitialChunksRemaining = ChunkData::GetInitialChunkCount(InitialRadius);
+
+	// Fields edited without the setters still reach the generator, chunks are versioned with what actually generates them
+	if (TerrainGenerator)
+	{
+		TerrainGenerator->SetTerrainLayers(TerrainLayers);
+	}
+	ParametersHash = ChunkData::GetParametersHash(TerrainParameters, BiomesParameters, TerrainLayers, ChunkSize);
+	PlayerPos = FVector::ZeroVector;
+	ChunkGrid.Reset(RenderDistance, FIntPoint::ZeroValue);
+	UpdateCollisionWindow();
+	UpdateMemoryBudget();
+
+	const FString SnapshotPath = FTerrainSnapshot::ResolvePath(StreamingSettings.StartupSnapshot.FilePath);
+	if (!SnapshotPath.IsEmpty())
+	{
+		StartupSnapshotLoad = FTerrainSnapshot::LoadAsync(SnapshotPath);
+		return;
+	}
+	RequestInitialChunks(nullptr);
+}
+
+/**
+ * @brief Requests the chunks the player waits for
+ * @param Snapshot Startup snapshot, null if none is configured or it could not be read
+ * @details A snapshot baked with the current parameters holds the spawn rings, their jobs only build the meshes.
+ *          Only those rings hold the player, the rest of the render window is streamed in once they are displayed.
+ *          The rings are requested in a single batch, nearest chunks first
+ */
+void UChunkManagerWorldSubsystem::RequestInitialChunks(FTerrainSnapshotPtr Snapshot)
+{
+	if (Snapshot.IsValid() && Snapshot->GetParametersHash() == ParametersHash)
+	{
+		InitialRadius = FMath::Min(InitialRadius, Snapshot->GetRadius());
+		InitialChunksRemaining = ChunkData::GetInitialChunkCount(InitialRadius);
+		if (TerrainGenerator)
+		{
+			TerrainGenerator->SetStartupSnapshot(Snapshot);
 		}
 	}
+	else if (Snapshot.IsValid())
+	{
+		UE_LOG(LogPTG, Warning, TEXT("Startup snapshot baked with parameters %08x, the terrain uses %08x, it is ignored"), Snapshot->GetParametersHash(), ParametersHash);
+	}
+
+	// One batch, so the GPU backend splits the burst into dispatches of MaxChunksPerGPUDispatch chunks
+	TArray<FChunkGenerationRequest> Requests;
+	Requests.Reserve(ChunkData::GetInitialChunkCount(InitialRadius));
+	for (int y = -InitialRadius; y <= InitialRadius; y++)
+	{
+		for (int x = -InitialRadius; x <= InitialRadius; x++)
+		{
+			TrackChunk(FIntPoint(x, y));
+			Requests.Add({ x * (ChunkSize - 1), y * (ChunkSize - 1), (float)FVector2D(x, y).Size(), GetChunkLOD(x, y) });
+		}
+	}
+
+	if (TerrainGenerator)
+	{
+		TerrainGenerator->GenerateChunks(Requests, ChunkSize, TerrainParameters, BiomesParameters);
+	}
 }
 
 /**
@@ -186,14 +1110,17 @@ void UChunkManagerWorldSubsystem::InitialChunkGeneration(int32 InRenderDistance)
  * @param X X-coordinate of chunk origin
  * @param Y Y-coordinate of chunk origin
  * @param Size Size of chunk in vertices
+ * @param Priority Scheduling priority, lower values are generated first
+ * @param LOD Level of detail of the chunk
  */
-void UChunkManagerWorldSubsystem::RequestChunkGeneration(int32 X, int32 Y, int32 Size)
+void UChunkManagerWorldSubsystem::RequestChunkGeneration(int32 X, int32 Y, int32 Size, float Priority, int32 LOD)
 {
-	UE_LOG(LogTemp, Warning, TEXT("Requested Chunk Generation"));
+	UE_LOG(LogPTGChunk, Verbose, TEXT("Requested Chunk Generation at X: %d, Y: %d"), X, Y);
 
 	if (TerrainGenerator)
 	{
-		TerrainGenerator->GenerateChunk(X, Y, Size, TerrainParameters, BiomesParameters);
+		const FChunkGenerationRequest Request = { X, Y, Priority, LOD };
+		TerrainGenerator->GenerateChunks(MakeArrayView(&Request, 1), Size, TerrainParameters, BiomesParameters);
 	}
 }
 
@@ -221,31 +1148,36 @@ void UChunkManagerWorldSubsystem::OnChunkGenerated(int64 ChunkId)
 		InitialChunksRemaining--;
 
 		OnLoadingProgressUpdate.Broadcast(
-			ChunkData::GetInitialChunkCount(RenderDistance) - InitialChunksRemaining,
-			ChunkData::GetInitialChunkCount(RenderDistance)
+			ChunkData::GetInitialChunkCount(InitialRadius) - InitialChunksRemaining,
+			ChunkData::GetInitialChunkCount(InitialRadius)
 		);
         
 		if (InitialChunksRemaining <= 0)
 		{
 			bInitialChunksGenerated = true;
-			UE_LOG(LogTemp, Warning, TEXT("Initial chunks generation complete!"));
+			UE_LOG(LogPTG, Log, TEXT("Initial chunks generation complete in %.0f ms!"), (FPlatformTime::Seconds() - InitialGenerationStartTime) * 1000.0);
+
+			// Rings beyond the startup snapshot
+			if (InitialRadius < RenderDistance)
+			{
+				UpdateGenerationQueue();
+			}
 		}
 	}
     
-	if (bStressTestInProgress)
+	if (bStressTestInProgress && PendingStressTestChunks.Remove(ChunkId) > 0)
 	{
-		PendingChunks--;
-        
-		if (PendingChunks <= 0)
+		if (PendingStressTestChunks.IsEmpty())
 		{
 			double EndTime = FPlatformTime::Seconds();
 			double TotalTime = (EndTime - StressTestStartTime) * 1000.0;
             
-			UE_LOG(LogTemp, Warning, TEXT("Stress Test Complete:"));
-			UE_LOG(LogTemp, Warning, TEXT("  Total Time: %.2f ms"), TotalTime);
-			UE_LOG(LogTemp, Warning, TEXT("  Average Time per Chunk: %.2f ms"), TotalTime / PendingChunks);
+			UE_LOG(LogPTG, Log, TEXT("Stress Test Complete:"));
+			UE_LOG(LogPTG, Log, TEXT("  Total Time: %.2f ms"), TotalTime);
+			UE_LOG(LogPTG, Log, TEXT("  Average Time per Chunk: %.2f ms"), TotalTime / StressTestChunkCount);
             
 			bStressTestInProgress = false;
+			ReleaseStressTestChunks();
 		}
 	}
     
@@ -4,6 +4,8 @@
 #include "Tickable.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "PTG/Generation/Terrain/ChunkData.h"
+#include "PTG/Generation/Terrain/ChunkRingGrid.h"
+#include "PTG/Generation/Terrain/TerrainSnapshot.h"
 #include "PTG/Generation/Subsystems/ProceduralMeshGeneratorSubsystem.h"
 #include "ChunkManagerWorldSubsystem.generated.h"
 
@@ -37,6 +39,8 @@ public:
 	void InitialChunkGeneration(int32 InRenderDistance);
 	UFUNCTION(BlueprintCallable)
 	void StressTest(int32 NumChunks);
+	UFUNCTION(BlueprintCallable, Category = "Terrain Generation")
+	void RebuildVisibleTerrain();
 
 	/// Getters
 	UFUNCTION(BlueprintCallable)
@@ -44,13 +48,22 @@ public:
 	UFUNCTION(BlueprintCallable)
 	int32 GetChunkSize() const { return ChunkSize; }
 
+	/// Memory
+	uint64 GetTerrainMemory() const;
+	UFUNCTION(BlueprintCallable, Category = "Terrain Generation")
+	void LogMemoryReport() const;
+
 	/// Setters
 	UFUNCTION(BlueprintCallable, Category = "Terrain Generation")
-	void SetTerrainParameters(const FPerlinParameters& Parameters) { TerrainParameters = Parameters; }
+	void SetTerrainParameters(const FPerlinParameters& Parameters) { TerrainParameters = Parameters; OnParametersChanged(); }
 	UFUNCTION(BlueprintCallable, Category = "Terrain Generation") 
-	void SetBiomesParameters(const FPerlinParameters& Parameters) { BiomesParameters = Parameters; }
+	void SetBiomesParameters(const FPerlinParameters& Parameters) { BiomesParameters = Parameters; OnParametersChanged(); }
+	UFUNCTION(BlueprintCallable, Category = "Terrain Generation")
+	void SetTerrainLayers(const FTerrainLayerSettings& Settings);
 	UFUNCTION(BlueprintCallable,Category = "Terrain Generation")
-	void SetRenderDistance(int32 _RenderDistance) { RenderDistance = _RenderDistance; }
+	void SetRenderDistance(int32 _RenderDistance) { RenderDistance = _RenderDistance; UpdateMemoryBudget(); }
+	UFUNCTION(BlueprintCallable, Category = "Terrain Generation")
+	void SetStreamingSettings(const FChunkStreamingSettings& Settings);
 
 	//////// DELEGATES IMPLEMENTATION ////////
 	UPROPERTY(BlueprintAssignable)
@@ -70,25 +83,98 @@ private:
 	UPROPERTY(EditAnywhere)
 	FPerlinParameters BiomesParameters;
 	UPROPERTY(EditAnywhere)
+	FTerrainLayerSettings TerrainLayers;
+
+	/// Hash of the current parameters and layers, chunks generated with another one are out of date
+	uint32 ParametersHash = 0;
+	UPROPERTY(EditAnywhere)
 	int32 ChunkSize = 64;
 	UPROPERTY(EditAnywhere)
 	int32 RenderDistance = 10;
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"))
+	float ViewDirectionWeight = 0.5f;
+	UPROPERTY(EditAnywhere)
+	FChunkStreamingSettings StreamingSettings;
+
+	/// Pending generation request, ordered nearest first
+	struct FChunkRequest
+	{
+		FIntPoint Coords;
+		float Priority;
+		int32 LOD = 0;
+		bool bPrefetch = false;
+
+		bool operator<(const FChunkRequest& Other) const { return Priority < Other.Priority; }
+	};
 
 	/// Runtime Data
 	FVector PlayerPos;
-	TQueue<FVector2D> ChunkGenerationQueue;
+	FVector2D PlayerViewDirection = FVector2D::ZeroVector;
+	FVector2D PlayerVelocity = FVector2D::ZeroVector;
+	TArray<FChunkRequest> ChunkGenerationQueue;
+	FChunkRingGrid ChunkGrid;
+	FIntPoint CollisionCenter = FIntPoint::ZeroValue;
+	int32 CollisionWindowRadius = INDEX_NONE;
 	TQueue<int64> ChunkDestructionQueue;
 	float TimeSinceLastChunkOperation = 0.0f;
-	float ChunkOperationInterval = 0.05f;
+	float AverageFrameTimeMs = 16.6f;
 	bool bStressTestInProgress = false;
 	bool bInitialChunksGenerated;
 	double StressTestStartTime = 0.0;
-	int32 PendingChunks = 0;
+	int32 StressTestChunkCount = 0;
+
+	/// Stress test chunks not generated yet, other chunks completing meanwhile do not count
+	TSet<int64> PendingStressTestChunks;
+
+	/// Cells of the stress test chunks, handed to the render window or destroyed once the test completes
+	TArray<FIntPoint> StressTestCells;
 	int32 InitialChunksRemaining;
 
+	/// Chunks requested ahead of the render window, released once they enter it or fall behind
+	TSet<int64> PrefetchedChunks;
+	float TimeSinceLastPrefetch = 0.0f;
+	static constexpr float PrefetchInterval = 0.2f;
+	static constexpr float PrefetchPriorityBias = 10000.0f;
+
+	/// Memory budget, 0 keeps the LOD ring width of the streaming settings
+	int32 BudgetLODRingWidth = 0;
+	bool bMemoryBudgetLODChanged = false;
+	bool bMemoryBudgetExceeded = false;
+
+	/// Initial generation, limited to the rings of the startup snapshot when one matches the parameters
+	TFuture<FTerrainSnapshotPtr> StartupSnapshotLoad;
+	int32 InitialRadius = 0;
+	double InitialGenerationStartTime = 0.0;
+
 	//////// METHODS ////////
 	/// Chunk management
-	void RequestChunkGeneration(int32 X, int32 Y, int32 Size);
+	void RequestInitialChunks(FTerrainSnapshotPtr Snapshot);
+	void RequestChunkGeneration(int32 X, int32 Y, int32 Size, float Priority = 0.0f, int32 LOD = 0);
 	void RequestChunkDestruction(int64 ChunkId);
 	void OnChunkGenerated(int64 ChunkId);
+	void ReleaseStressTestChunks();
+	void OnParametersChanged();
+	void UpdateStreamingWindow();
+	void UpdateGenerationQueue();
+	void QueueChunkIfNeeded(const FIntPoint& Cell);
+	void TrackChunk(const FIntPoint& Cell);
+	void UpdateChunkDestruction();
+	void UpdateCollisionWindow();
+	void UpdatePrefetch();
+	void ReleasePrefetchedChunks();
+	bool UpdateMemoryBudget();
+	bool ReserveChunkMemory(const FChunkRequest& Request, uint64& InOutReservedBytes);
+	void DispatchChunkGenerationBatch();
+	bool PopChunkRequest(FChunkRequest& OutRequest);
+	bool DestroyNextChunk();
+
+	/// Helpers
+	float GetChunkPriority(int32 X, int32 Y) const;
+	int32 GetChunkLOD(int32 X, int32 Y) const;
+	bool IsChunkInRange(const FChunk& Chunk) const;
+	bool IsChunkRequested(const FIntPoint& Cell, int32 LOD) const;
+	double GetFrameBudgetSeconds() const;
+	int32 GetLODRingWidth() const { return BudgetLODRingWidth > 0 ? BudgetLODRingWidth : FMath::Max(StreamingSettings.LODRingWidth, 1); }
+	uint64 GetMemoryBudgetBytes() const { return (uint64)FMath::Max(StreamingSettings.MemoryBudgetMB, 0) * 1024 * 1024; }
+	uint64 EstimateWindowMemory(int32 RingWidth) const;
 };
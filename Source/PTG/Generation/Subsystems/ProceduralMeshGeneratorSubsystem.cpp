@@ -1,5 +1,6 @@
 ﻿#include "PTG/Generation/Subsystems/ProceduralMeshGeneratorSubsystem.h"
 #include "ProceduralMeshComponent.h"
+#include "PTG/PTG.h"
 
 /**
  * @file ProceduralMeshGeneratorSubsystem.cpp
@@ -15,6 +16,7 @@ void UProceduralMeshGeneratorSubsystem::Initialize(FSubsystemCollectionBase& Col
 
 void UProceduralMeshGeneratorSubsystem::Deinitialize()
 {
+	TopologyCache.Empty();
 	Super::Deinitialize();
 }
 /**
@@ -22,47 +24,236 @@ void UProceduralMeshGeneratorSubsystem::Deinitialize()
  * @param ProceduralMesh Target mesh component to apply
  * @param Chunk Data structure containing terrain information
  * @param SectionIndex Index of the mesh section to create
- * @details Generates complete mesh data including:
- *          - Vertex positions from height data
- *          - Triangle indices for mesh topology
- *          - Normal vectors for lighting calculations
- *          - UV coordinates for texturing
+ * @details Builds the mesh data on the calling thread, streamed chunks come with data built by the workers
  */
 void UProceduralMeshGeneratorSubsystem::CreateChunkMesh(UProceduralMeshComponent* ProceduralMesh, const FChunk& Chunk, int32 SectionIndex)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UProceduralMeshGeneratorSubsystem::CreateChunkMesh);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_CreateChunkMesh);
+
+	FChunkMeshData MeshData;
+	BuildChunkMeshData(Chunk, GetChunkTopology(Chunk.Size, Chunk.LOD), MeshData);
+	UploadChunkMesh(ProceduralMesh, MeshData, SectionIndex);
+}
+
+/**
+ * @brief Uploads prebuilt mesh data to a mesh section
+ * @param ProceduralMesh Target mesh component to apply
+ * @param MeshData Buffers built by BuildChunkMeshData
+ * @param SectionIndex Index of the mesh section to create
+ * @details A section left by a chunk of the same layout is updated in place, keeping its index buffer.
+ *          The layout only depends on the resolution and skirts, so matching counts mean matching indices.
+ *          Render sections never cook collision, see CreateChunkCollision
+ */
+void UProceduralMeshGeneratorSubsystem::UploadChunkMesh(UProceduralMeshComponent* ProceduralMesh, const FChunkMeshData& MeshData, int32 SectionIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UProceduralMeshGeneratorSubsystem::UploadChunkMesh);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_UploadChunkMesh);
+
+	if (const FProcMeshSection* Section = ProceduralMesh->GetProcMeshSection(SectionIndex))
+	{
+		if (Section->ProcVertexBuffer.Num() == MeshData.Vertices.Num() && Section->ProcIndexBuffer.Num() == MeshData.Topology->Triangles.Num())
+		{
+			ProceduralMesh->UpdateMeshSection_LinearColor(
+				SectionIndex,
+				MeshData.Vertices,
+				MeshData.Normals,
+				MeshData.Topology->UVs,
+				TArray<FLinearColor>(),
+				TArray<FProcMeshTangent>()
+			);
+			return;
+		}
+	}
+
+	ProceduralMesh->CreateMeshSection_LinearColor(
+		SectionIndex,
+		MeshData.Vertices,
+		MeshData.Topology->Triangles,
+		MeshData.Normals,
+		MeshData.Topology->UVs,
+		TArray<FLinearColor>(),
+		TArray<FProcMeshTangent>(),
+		false
+	);
+}
+
+/**
+ * @brief Creates the hidden collision section of a terrain chunk
+ * @param ProceduralMesh Target mesh component, chunk mesh actors are spawned with asynchronous cooking
+ * @param Chunk Generated chunk
+ * @param CollisionLOD Level of detail of the collision mesh, never finer than the chunk grid
+ * @param SectionIndex Index of the collision section, kept apart from the render sections
+ * @details The collision grid takes every 2^(CollisionLOD - LOD) vertex of the chunk grid, its own clamped last row
+ *          and column matching the chunk edges so neighbors stay watertight
+ */
+void UProceduralMeshGeneratorSubsystem::CreateChunkCollision(UProceduralMeshComponent* ProceduralMesh, const FChunk& Chunk, int32 CollisionLOD, int32 SectionIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UProceduralMeshGeneratorSubsystem::CreateChunkCollision);
+
+	const int32 LOD = GetCollisionMeshLOD(Chunk.Size, Chunk.LOD, CollisionLOD);
+	const FChunkTopologyPtr Topology = GetChunkTopology(Chunk.Size, LOD, false);
+	const int32 Resolution = Topology->Resolution;
+	const int32 Stride = 1 << (LOD - Chunk.LOD);
+	const int32 LastVertex = Chunk.GetResolution() - 1;
+
 	TArray<FVector> Vertices;
-	TArray<int32> Triangles;
-	TArray<FVector> Normals;
-	TArray<FVector2D> UVs;
+	Vertices.SetNumUninitialized(Resolution * Resolution);
+	for (int32 y = 0; y < Resolution; y++)
+	{
+		for (int32 x = 0; x < Resolution; x++)
+		{
+			Vertices[x + y * Resolution] = Chunk.GetVertexPosition(FMath::Min(x * Stride, LastVertex), FMath::Min(y * Stride, LastVertex));
+		}
+	}
+
+	ProceduralMesh->CreateMeshSection(
+		SectionIndex,
+		Vertices,
+		Topology->Triangles,
+		TArray<FVector>(),
+		TArray<FVector2D>(),
+		TArray<FColor>(),
+		TArray<FProcMeshTangent>(),
+		true
+	);
+	ProceduralMesh->SetMeshSectionVisible(SectionIndex, false);
+}
+
+/**
+ * @brief Builds the render buffers of a terrain chunk
+ * @param Chunk Data structure containing terrain information
+ * @param Topology Shared triangle indices and UVs of the chunk layout
+ * @param OutMeshData Filled buffers
+ * @param ApronHeights Heights one sample step outside the South, North, West and East edges, one-sided differences are used where missing
+ * @param SkirtDepth Depth of the skirt vertices below the edges, used when the topology has skirts
+ * @details Touches no UObject, called from the chunk workers. Generates per chunk:
+ *          - Vertex positions from height data
+ *          - Normal vectors from central differences of the height grid
+ *          - Skirt vertices copied from the edges and lowered by SkirtDepth
+ */
+void UProceduralMeshGeneratorSubsystem::BuildChunkMeshData(const FChunk& Chunk, const FChunkTopologyPtr& Topology, FChunkMeshData& OutMeshData, const TArray<float>* ApronHeights, float SkirtDepth)
+{
+	TArray<FVector>& Vertices = OutMeshData.Vertices;
+	TArray<FVector>& Normals = OutMeshData.Normals;
+	OutMeshData.Topology = Topology;
 
-	const int32 NumVertices = Chunk.Size * Chunk.Size;
-	const int32 NumTriangles = (Chunk.Size - 1) * (Chunk.Size - 1) * 2 * 3;
+	const int32 Resolution = Chunk.GetResolution();
+	const int32 NumGridVertices = Resolution * Resolution;
+	const int32 NumVertices = NumGridVertices + (Topology->bSkirts ? 4 * Resolution : 0);
+	const TArray<float>& Heights = Chunk.GetHeights();
+	const double Spacing = 100.0;
+	const double ApronSpacing = Chunk.GetSampleStep() * Spacing;
 
 	Vertices.Reserve(NumVertices);
-	Triangles.Reserve(NumTriangles);
-	Normals.Reserve(NumVertices);
-	UVs.Reserve(NumVertices);
+	Normals.SetNumUninitialized(NumVertices);
 	
-	for (int32 y = 0; y < Chunk.Size; y++)
+	for (int32 y = 0; y < Resolution; y++)
 	{
-		for (int32 x = 0; x < Chunk.Size; x++)
+		for (int32 x = 0; x < Resolution; x++)
 		{
-			int32 Index = x + y * Chunk.Size;
-			Vertices.Add(Chunk.VertexArray[Index].Coords);
-			
-			float U = static_cast<float>(x) / (Chunk.Size - 1);
-			float V = static_cast<float>(y) / (Chunk.Size - 1);
+			Vertices.Add(Chunk.GetVertexPosition(x, y));
+		}
+	}
+
+	auto HasApron = [ApronHeights, Resolution](EChunkBorder Border) { return ApronHeights && ApronHeights[(int32)Border].Num() == Resolution; };
+	const bool bSouth = HasApron(EChunkBorder::South);
+	const bool bNorth = HasApron(EChunkBorder::North);
+	const bool bWest = HasApron(EChunkBorder::West);
+	const bool bEast = HasApron(EChunkBorder::East);
+
+	for (int32 y = 0; y < Resolution; y++)
+	{
+		const float* Row = Heights.GetData() + y * Resolution;
+		const double DistanceDown = y > 0 ? (Chunk.GetSampleOffset(y) - Chunk.GetSampleOffset(y - 1)) * Spacing : (bSouth ? ApronSpacing : 0.0);
+		const double DistanceUp = y < Resolution - 1 ? (Chunk.GetSampleOffset(y + 1) - Chunk.GetSampleOffset(y)) * Spacing : (bNorth ? ApronSpacing : 0.0);
+
+		for (int32 x = 0; x < Resolution; x++)
+		{
+			// Neighbor samples, taken from the apron outside the grid and falling back to the vertex itself
+			const float Left = x > 0 ? Row[x - 1] : (bWest ? ApronHeights[(int32)EChunkBorder::West][y] : Row[x]);
+			const float Right = x < Resolution - 1 ? Row[x + 1] : (bEast ? ApronHeights[(int32)EChunkBorder::East][y] : Row[x]);
+			const float Down = y > 0 ? Row[x - Resolution] : (bSouth ? ApronHeights[(int32)EChunkBorder::South][x] : Row[x]);
+			const float Up = y < Resolution - 1 ? Row[x + Resolution] : (bNorth ? ApronHeights[(int32)EChunkBorder::North][x] : Row[x]);
+
+			const double DistanceLeft = x > 0 ? (Chunk.GetSampleOffset(x) - Chunk.GetSampleOffset(x - 1)) * Spacing : (bWest ? ApronSpacing : 0.0);
+			const double DistanceRight = x < Resolution - 1 ? (Chunk.GetSampleOffset(x + 1) - Chunk.GetSampleOffset(x)) * Spacing : (bEast ? ApronSpacing : 0.0);
+			const double SlopeX = (Right - Left) / (DistanceLeft + DistanceRight);
+			const double SlopeY = (Up - Down) / (DistanceDown + DistanceUp);
+
+			Normals[x + y * Resolution] = FVector(-SlopeX, -SlopeY, 1.0).GetUnsafeNormal();
+		}
+	}
+
+	if (Topology->bSkirts)
+	{
+		const FVector SkirtOffset(0.0, 0.0, SkirtDepth);
+		for (int32 Border = 0; Border < (int32)EChunkBorder::Count; Border++)
+		{
+			for (int32 i = 0; i < Resolution; i++)
+			{
+				const int32 EdgeIndex = GetEdgeVertexIndex((EChunkBorder)Border, i, Resolution);
+				Normals[Vertices.Num()] = Normals[EdgeIndex];
+				Vertices.Add(Vertices[EdgeIndex] - SkirtOffset);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Returns the cached topology of a chunk layout, building it on first use
+ * @param Size Size of the chunk in vertices at full resolution
+ * @param LOD Level of detail, each level halves the vertex density
+ * @param bSkirts Whether skirts are added below the edges
+ * @return Shared topology, safe to hand to worker threads
+ */
+FChunkTopologyPtr UProceduralMeshGeneratorSubsystem::GetChunkTopology(int32 Size, int32 LOD, bool bSkirts)
+{
+	const FIntVector Key(Size, LOD, bSkirts ? 1 : 0);
+	if (const FChunkTopologyPtr* CachedTopology = TopologyCache.Find(Key))
+	{
+		return *CachedTopology;
+	}
+
+	return TopologyCache.Add(Key, BuildChunkTopology(Size, LOD, bSkirts));
+}
+
+/**
+ * @brief Generates the triangle indices and UVs of a chunk layout
+ * @param Size Size of the chunk in vertices at full resolution
+ * @param LOD Level of detail, each level halves the vertex density
+ * @param bSkirts Whether skirts are added below the edges
+ * @return New topology
+ * @details UVs follow the full resolution sample offsets so textures line up between LODs.
+ *          Skirts are quads between each edge and its lowered copy, wound to face away from the chunk
+ */
+FChunkTopologyPtr UProceduralMeshGeneratorSubsystem::BuildChunkTopology(int32 Size, int32 LOD, bool bSkirts)
+{
+	TSharedRef<FChunkTopology, ESPMode::ThreadSafe> Topology = MakeShared<FChunkTopology, ESPMode::ThreadSafe>();
+	const int32 Resolution = FChunk::GetLODResolution(Size, LOD);
+	Topology->Resolution = Resolution;
+	Topology->bSkirts = bSkirts;
+
+	TArray<int32>& Triangles = Topology->Triangles;
+	TArray<FVector2D>& UVs = Topology->UVs;
+	Triangles.Reserve(((Resolution - 1) * (Resolution - 1) + (bSkirts ? 4 * (Resolution - 1) : 0)) * 2 * 3);
+	UVs.Reserve(Resolution * Resolution + (bSkirts ? 4 * Resolution : 0));
+
+	for (int32 y = 0; y < Resolution; y++)
+	{
+		for (int32 x = 0; x < Resolution; x++)
+		{
+			float U = static_cast<float>(FMath::Min(x << LOD, Size - 1)) / (Size - 1);
+			float V = static_cast<float>(FMath::Min(y << LOD, Size - 1)) / (Size - 1);
 			UVs.Add(FVector2D(U, V));
-			
-			Normals.Add(FVector(0.0f, 0.0f, 1.0f));
 		}
 	}
 
-	for (int32 y = 0; y < Chunk.Size - 1; y++)
+	for (int32 y = 0; y < Resolution - 1; y++)
 	{
-		for (int32 x = 0; x < Chunk.Size - 1; x++)
+		for (int32 x = 0; x < Resolution - 1; x++)
 		{
-			FSquareIndices Square = GetSquareIndices(x, y, Chunk.Size);
+			FSquareIndices Square = GetSquareIndices(x, y, Resolution);
 			
 			Triangles.Add(Square.bottomLeft);
 			Triangles.Add(Square.topLeft);
@@ -74,49 +265,153 @@ void UProceduralMeshGeneratorSubsystem::CreateChunkMesh(UProceduralMeshComponent
 		}
 	}
 
-	Normals.SetNum(Vertices.Num());
+	if (bSkirts)
+	{
+		for (int32 Border = 0; Border < (int32)EChunkBorder::Count; Border++)
+		{
+			const int32 FirstSkirtVertex = Resolution * Resolution + Border * Resolution;
+			const bool bFlip = (EChunkBorder)Border == EChunkBorder::North || (EChunkBorder)Border == EChunkBorder::West;
+
+			for (int32 i = 0; i < Resolution; i++)
+			{
+				UVs.Add(UVs[GetEdgeVertexIndex((EChunkBorder)Border, i, Resolution)]);
+			}
+
+			for (int32 i = 0; i < Resolution - 1; i++)
+			{
+				const int32 EdgeA = GetEdgeVertexIndex((EChunkBorder)Border, i, Resolution);
+				const int32 EdgeB = GetEdgeVertexIndex((EChunkBorder)Border, i + 1, Resolution);
+				const int32 SkirtA = FirstSkirtVertex + i;
+				const int32 SkirtB = FirstSkirtVertex + i + 1;
+
+				Triangles.Add(EdgeA);
+				Triangles.Add(bFlip ? SkirtA : EdgeB);
+				Triangles.Add(bFlip ? EdgeB : SkirtA);
 
-	for (FVector& Normal : Normals)
+				Triangles.Add(EdgeB);
+				Triangles.Add(bFlip ? SkirtA : SkirtB);
+				Triangles.Add(bFlip ? SkirtB : SkirtA);
+			}
+		}
+	}
+
+	return Topology;
+}
+
+/**
+ * @brief Computes the level of detail of a collision mesh
+ * @param Size Size of the chunk in vertices at full resolution
+ * @param LOD Level of detail of the chunk
+ * @param CollisionLOD Wanted level of detail of the collision mesh
+ * @return CollisionLOD, never finer than the chunk nor with a step wider than the chunk
+ */
+int32 UProceduralMeshGeneratorSubsystem::GetCollisionMeshLOD(int32 Size, int32 LOD, int32 CollisionLOD)
+{
+	int32 MeshLOD = FMath::Max(LOD, CollisionLOD);
+	while (MeshLOD > LOD && (1 << MeshLOD) > Size - 1)
 	{
-		Normal = FVector::ZeroVector;
+		MeshLOD--;
 	}
-	
-	for (int32 i = 0; i < Triangles.Num(); i += 3)
+	return MeshLOD;
+}
+
+/**
+ * @brief Returns the memory held by the cached topologies
+ * @return Bytes of the shared index and UV buffers
+ */
+uint64 UProceduralMeshGeneratorSubsystem::GetTopologyMemory() const
+{
+	uint64 Bytes = TopologyCache.GetAllocatedSize();
+	for (const auto& TopologyPair : TopologyCache)
 	{
-		const FVector& V0 = Vertices[Triangles[i]];
-		const FVector& V1 = Vertices[Triangles[i + 1]];
-		const FVector& V2 = Vertices[Triangles[i + 2]];
-
-		const FVector Edge1 = V1 - V0;
-		const FVector Edge2 = V2 - V0;
-		const FVector TriangleNormal = FVector::CrossProduct(Edge2, Edge1).GetSafeNormal();
-		
-		Normals[Triangles[i]] += TriangleNormal;
-		Normals[Triangles[i + 1]] += TriangleNormal;
-		Normals[Triangles[i + 2]] += TriangleNormal;
+		Bytes += sizeof(FChunkTopology) + TopologyPair.Value->Triangles.GetAllocatedSize() + TopologyPair.Value->UVs.GetAllocatedSize();
 	}
+	return Bytes;
+}
+
+/**
+ * @brief Estimates the memory a chunk will hold once generated and displayed
+ * @param Size Size of the chunk in vertices at full resolution
+ * @param LOD Level of detail of the chunk
+ * @param bSkirts Whether the render mesh has skirts
+ * @param CollisionLOD Level of detail of the collision mesh, INDEX_NONE for a render only chunk
+ * @return Estimated bytes, the same layout as the ones the terrain generator measures
+ */
+FChunkMemoryUsage UProceduralMeshGeneratorSubsystem::EstimateChunkMemory(int32 Size, int32 LOD, bool bSkirts, int32 CollisionLOD)
+{
+	FChunkMemoryUsage Usage;
+	const int32 Resolution = FChunk::GetLODResolution(Size, LOD);
+	Usage.HeightBytes = sizeof(FChunkHeights) + (uint64)Resolution * Resolution * sizeof(float);
 
-	// Normalize all normals
-	for (FVector& Normal : Normals)
+	const int32 NumVertices = Resolution * Resolution + (bSkirts ? 4 * Resolution : 0);
+	const int32 NumIndices = ((Resolution - 1) * (Resolution - 1) + (bSkirts ? 4 * (Resolution - 1) : 0)) * 2 * 3;
+	Usage.MeshBytes = EstimateSectionMemory(NumVertices, NumIndices, false);
+
+	if (CollisionLOD != INDEX_NONE)
 	{
-		if (!Normal.IsNearlyZero())
-		{
-			Normal.Normalize();
-		}
-		else
-		{
-			Normal = FVector(0, 0, 1);
-		}
+		const int32 CollisionResolution = FChunk::GetLODResolution(Size, GetCollisionMeshLOD(Size, LOD, CollisionLOD));
+		Usage.CollisionBytes = EstimateSectionMemory(CollisionResolution * CollisionResolution, (CollisionResolution - 1) * (CollisionResolution - 1) * 2 * 3, true);
 	}
+	return Usage;
+}
 
-	ProceduralMesh->CreateMeshSection_LinearColor(
-		SectionIndex,
-		Vertices,
-		Triangles,
-		Normals,
-		UVs,
-		TArray<FLinearColor>(),
-		TArray<FProcMeshTangent>(),
-		true
-	);
+/**
+ * @brief Estimates the memory of a mesh section
+ * @param NumVertices Vertices of the section
+ * @param NumIndices Triangle indices of the section
+ * @param bCollision Whether the section is a cooked collision section rather than a rendered one
+ * @return Bytes of the component buffers plus the GPU buffers or the cooked body
+ */
+uint64 UProceduralMeshGeneratorSubsystem::EstimateSectionMemory(int32 NumVertices, int32 NumIndices, bool bCollision)
+{
+	return (uint64)NumVertices * sizeof(FProcMeshVertex) + (uint64)NumIndices * sizeof(uint32) + GetDerivedSectionMemory(NumVertices, NumIndices, bCollision);
+}
+
+/**
+ * @brief Measures the memory of a mesh section
+ * @param ProceduralMesh Component holding the section
+ * @param SectionIndex Index of the section
+ * @param bCollision Whether the section cooks collision
+ * @return Allocated bytes of the section buffers plus the estimated GPU buffers or cooked body, 0 for an empty section
+ */
+uint64 UProceduralMeshGeneratorSubsystem::GetSectionMemory(UProceduralMeshComponent* ProceduralMesh, int32 SectionIndex, bool bCollision)
+{
+	const FProcMeshSection* Section = ProceduralMesh ? ProceduralMesh->GetProcMeshSection(SectionIndex) : nullptr;
+	if (!Section || Section->ProcVertexBuffer.Num() == 0)
+	{
+		return 0;
+	}
+
+	return Section->ProcVertexBuffer.GetAllocatedSize() + Section->ProcIndexBuffer.GetAllocatedSize()
+		+ GetDerivedSectionMemory(Section->ProcVertexBuffer.Num(), Section->ProcIndexBuffer.Num(), bCollision);
+}
+
+/**
+ * @brief Estimates the memory derived from the buffers of a mesh section
+ * @param NumVertices Vertices of the section
+ * @param NumIndices Triangle indices of the section
+ * @param bCollision Whether the section cooks collision
+ * @return Bytes of the cooked body of collision sections, of the GPU vertex and index buffers of rendered ones
+ */
+uint64 UProceduralMeshGeneratorSubsystem::GetDerivedSectionMemory(int32 NumVertices, int32 NumIndices, bool bCollision)
+{
+	return bCollision
+		? NumVertices * CollisionBytesPerVertex + NumIndices * CollisionBytesPerIndex
+		: NumVertices * RenderBytesPerVertex + (uint64)NumIndices * sizeof(uint32);
+}
+
+/**
+ * @brief Measures the memory of every section of a mesh component
+ * @param ProceduralMesh Component to measure, sections are counted as rendered
+ * @return Bytes of the sections left in the component
+ */
+uint64 UProceduralMeshGeneratorSubsystem::GetMeshMemory(UProceduralMeshComponent* ProceduralMesh)
+{
+	uint64 Bytes = 0;
+	const int32 NumSections = ProceduralMesh ? ProceduralMesh->GetNumSections() : 0;
+	for (int32 SectionIndex = 0; SectionIndex < NumSections; SectionIndex++)
+	{
+		Bytes += GetSectionMemory(ProceduralMesh, SectionIndex, false);
+	}
+	return Bytes;
 }
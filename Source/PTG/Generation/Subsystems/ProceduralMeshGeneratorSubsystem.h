@@ -31,8 +31,43 @@ public:
 	/// Mesh generation
 	UFUNCTION()
 	void CreateChunkMesh(UProceduralMeshComponent* ProceduralMesh, const FChunk& Chunk, int32 SectionIndex = 0);
+	static void UploadChunkMesh(UProceduralMeshComponent* ProceduralMesh, const FChunkMeshData& MeshData, int32 SectionIndex = 0);
+	void CreateChunkCollision(UProceduralMeshComponent* ProceduralMesh, const FChunk& Chunk, int32 CollisionLOD, int32 SectionIndex);
+
+	/// Mesh data, thread safe
+	static void BuildChunkMeshData(const FChunk& Chunk, const FChunkTopologyPtr& Topology, FChunkMeshData& OutMeshData, const TArray<float>* ApronHeights = nullptr, float SkirtDepth = 0.0f);
+
+	/// Topology cache
+	FChunkTopologyPtr GetChunkTopology(int32 Size, int32 LOD = 0, bool bSkirts = false);
+	static FChunkTopologyPtr BuildChunkTopology(int32 Size, int32 LOD, bool bSkirts);
+	uint64 GetTopologyMemory() const;
+
+	/// Memory accounting
+	static FChunkMemoryUsage EstimateChunkMemory(int32 Size, int32 LOD, bool bSkirts, int32 CollisionLOD = INDEX_NONE);
+	static uint64 EstimateSectionMemory(int32 NumVertices, int32 NumIndices, bool bCollision);
+	static uint64 GetSectionMemory(UProceduralMeshComponent* ProceduralMesh, int32 SectionIndex, bool bCollision);
+	static uint64 GetMeshMemory(UProceduralMeshComponent* ProceduralMesh);
+	static int32 GetCollisionMeshLOD(int32 Size, int32 LOD, int32 CollisionLOD);
 
 	/// Helpers
+	/**
+	 * @brief Utility function to calculate the grid index of a vertex along a chunk edge
+	 * @param Border Edge of the grid
+	 * @param i Position along the edge, increasing with x or y
+	 * @param gridSize Size of the complete grid
+	 * @return Index of the vertex in the grid
+	 */
+	static FORCEINLINE int32 GetEdgeVertexIndex(EChunkBorder Border, int32 i, int32 gridSize)
+	{
+		switch (Border)
+		{
+		case EChunkBorder::South: return i;
+		case EChunkBorder::North: return i + (gridSize - 1) * gridSize;
+		case EChunkBorder::West: return i * gridSize;
+		default: return (gridSize - 1) + i * gridSize;
+		}
+	}
+
 	/**
 	 * @brief Utility function to calculate indices for a grid square
 	 * @param x X coordinate in the grid
@@ -40,7 +75,7 @@ public:
 	 * @param gridSize Size of the complete grid
 	 * @return FSquareIndices Structure containing vertex indices for the square
 	 */
-	FORCEINLINE FSquareIndices GetSquareIndices(int32 x, int32 y, int32 gridSize)
+	static FORCEINLINE FSquareIndices GetSquareIndices(int32 x, int32 y, int32 gridSize)
 	{
 		return
 		{
@@ -50,4 +85,19 @@ public:
 			(x + 1) + (y + 1) * gridSize
 		};
 	}
+
+private:
+	//////// FIELDS ////////
+	/// Topologies keyed by (Size, LOD, skirts), built once and shared with every chunk and worker
+	TMap<FIntVector, FChunkTopologyPtr> TopologyCache;
+
+	/// GPU bytes per render vertex: position, packed tangent basis, four half precision UV channels and color
+	static constexpr uint64 RenderBytesPerVertex = 12 + 8 + 4 * 4 + 4;
+
+	/// Cooked collision keeps a float position per vertex and an index per triangle corner
+	static constexpr uint64 CollisionBytesPerVertex = 12;
+	static constexpr uint64 CollisionBytesPerIndex = 4;
+
+	//////// METHODS ////////
+	static uint64 GetDerivedSectionMemory(int32 NumVertices, int32 NumIndices, bool bCollision);
 };
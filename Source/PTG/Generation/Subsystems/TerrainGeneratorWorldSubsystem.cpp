@@ -1,8 +1,11 @@
 ﻿#include "PTG/Generation/Subsystems/TerrainGeneratorWorldSubsystem.h"
+#include "PTG/PTG.h"
 #include "ProceduralMeshComponent.h"
+#include "Async/ParallelFor.h"
 #include "ProceduralMeshGeneratorSubsystem.h"
 #include "PTG/Generation/Terrain/ChunkData.h"
-#include "PTG/Generation/Terrain/ChunkThread.h"
+#include "PTG/Generation/Terrain/ChunkScheduler.h"
+#include "PTG/Generation/Utils/PerlinNoise.h"
 
 /**
  * @file TerrainGeneratorWorldSubsystem.cpp
@@ -10,9 +13,65 @@
  * @details Handles terrain chunk generation, mesh creation, and material application
  */
 
+/**
+ * @brief Fills a job with the heights of its chunk computed on the GPU
+ * @param Job Job whose chunk and missing aprons are filled
+ * @param Grid Extended grid of the chunk, one apron sample on every side
+ * @param GridResolution Samples per side of the extended grid
+ * @details Edges and aprons copied from generated neighbors are kept, as on the CPU path
+ */
+static void ApplyComputedHeights(FChunkJob& Job, TConstArrayView<float> Grid, int32 GridResolution)
+{
+	const int32 Resolution = Job.Chunk.GetResolution();
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(Resolution * Resolution);
+
+	for (int32 Row = 0; Row < Resolution; Row++)
+	{
+		FMemory::Memcpy(Heights.GetData() + Row * Resolution, Grid.GetData() + (Row + 1) * GridResolution + 1, Resolution * sizeof(float));
+	}
+
+	for (int32 Border = 0; Border < (int32)EChunkBorder::Count; Border++)
+	{
+		const TArray<float>& BorderHeights = Job.BorderHeights[Border];
+		TArray<float>& ApronHeights = Job.ApronHeights[Border];
+
+		if (BorderHeights.Num() == Resolution)
+		{
+			for (int32 i = 0; i < Resolution; i++)
+			{
+				Heights[UProceduralMeshGeneratorSubsystem::GetEdgeVertexIndex((EChunkBorder)Border, i, Resolution)] = BorderHeights[i];
+			}
+		}
+
+		// Apron samples are the outer ring of the extended grid, its corners are unused
+		if (ApronHeights.Num() != Resolution)
+		{
+			ApronHeights.SetNumUninitialized(Resolution);
+			for (int32 i = 0; i < Resolution; i++)
+			{
+				ApronHeights[i] = Grid[UProceduralMeshGeneratorSubsystem::GetEdgeVertexIndex((EChunkBorder)Border, i + 1, GridResolution)];
+			}
+		}
+	}
+
+	float min = Heights[0];
+	float max = Heights[0];
+	for (float Height : Heights)
+	{
+		min = FMath::Min(min, Height);
+		max = FMath::Max(max, Height);
+	}
+
+	Job.Chunk.HeightData = MakeShared<FChunkHeights, ESPMode::ThreadSafe>(MoveTemp(Heights), min, max);
+	Job.bComputedOnGPU = true;
+}
+
 void UTerrainGeneratorWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	Scheduler = MakeUnique<FChunkScheduler>(FChunkScheduler::GetDefaultWorkerCount(), TPri_BelowNormal);
 }
 
 /**
@@ -21,19 +80,27 @@ void UTerrainGeneratorWorldSubsystem::Initialize(FSubsystemCollectionBase& Colle
  */
 void UTerrainGeneratorWorldSubsystem::Deinitialize()
 {
+	for (auto& JobPair : PendingJobs)
+	{
+		JobPair.Value->Cancel();
+	}
+	PendingJobs.Empty();
+	GPUBatches.Empty();
+	ReadyMeshData.Empty();
+	Scheduler.Reset();
+	DiskCache.Reset();
+
 	for (auto& MeshPair : MeshMap)
 	{
-		if (AActor* Mesh = MeshPair.Value)
-		{
-			if (UProceduralMeshComponent* ProceduralMesh = Mesh->FindComponentByClass<UProceduralMeshComponent>())
-			{
-				ProceduralMesh->ClearMeshSection(0);
-			}
-			Mesh->Destroy();
-		}
+		DestroyMeshActor(MeshPair.Value);
 	}
+	EmptyMeshActorPool();
 	MeshMap.Empty();
 	ChunkMap.Empty();
+	CollisionChunks.Empty();
+	RegionMap.Empty();
+	ChunkMemory.Empty();
+	ResidentMemory = FChunkMemoryUsage();
 	
 	Super::Deinitialize();
 }
@@ -45,19 +112,170 @@ void UTerrainGeneratorWorldSubsystem::Deinitialize()
  * @param Size Size of chunk in vertices
  * @param TerrainParameters Perlin noise parameters for height generation
  * @param BiomesParameters Perlin noise parameters for biome variation
+ * @param Priority Scheduling priority, lower values are generated first
  */
-void UTerrainGeneratorWorldSubsystem::GenerateChunk(int32 X, int32 Y, int32 Size, const FPerlinParameters& TerrainParameters, const FPerlinParameters& BiomesParameters)
+void UTerrainGeneratorWorldSubsystem::GenerateChunk(int32 X, int32 Y, int32 Size, const FPerlinParameters& TerrainParameters, const FPerlinParameters& BiomesParameters, float Priority)
 {
-	UE_LOG(LogTemp, Warning, TEXT("Starting chunk generation at X: %d, Y: %d"), X, Y);
-	
-	FChunk NewChunk;
-	NewChunk.Size = Size;
-	NewChunk.Coords = FVector(X, Y, 0);
-	NewChunk.Id = ChunkData::GetChunkIdFromCoordinates(X, Y);
+	const FChunkGenerationRequest Request = { X, Y, Priority, 0 };
+	GenerateChunks(MakeArrayView(&Request, 1), Size, TerrainParameters, BiomesParameters);
+}
+
+/**
+ * @brief Initiates generation of several terrain chunks at once
+ * @param Requests Origins, priorities and levels of detail of the chunks to generate
+ * @param Size Size of chunks in vertices
+ * @param TerrainParameters Perlin noise parameters for height generation
+ * @param BiomesParameters Perlin noise parameters for biome variation, read by the layers using the biome mask
+ * @details The whole batch is handed to the workers under a single queue lock,
+ *          edges shared with already generated neighbors are handed to the jobs so workers skip them.
+ *          A chunk regenerated at another LOD or with other parameters keeps its data and mesh until the new one is ready.
+ *          With the GPU backend heights are computed by compute dispatches of chunks sharing a LOD, the workers only build the meshes.
+ *          Chunks of the startup snapshot or the disk cache are read back by the workers whatever the backend
+ */
+void UTerrainGeneratorWorldSubsystem::GenerateChunks(TConstArrayView<FChunkGenerationRequest> Requests, int32 Size, const FPerlinParameters& TerrainParameters, const FPerlinParameters& BiomesParameters)
+{
+	TArray<FChunkJobRef, TInlineAllocator<16>> Jobs;
+	Jobs.Reserve(Requests.Num());
+
+	// Jobs of the same LOD share the same cached index and UV layout
+	UProceduralMeshGeneratorSubsystem* MeshGenerator = GetWorld()->GetGameInstance()->GetSubsystem<UProceduralMeshGeneratorSubsystem>();
+	const bool bSkirts = SkirtDepth > 0.0f;
+
+	// The graph is only compiled again when the parameters or layers changed
+	const uint32 ParametersHash = ChunkData::GetParametersHash(TerrainParameters, BiomesParameters, *LayerSettings, Size);
+	if (ParametersHash != QueryParametersHash || QueryChunkSize != Size)
+	{
+		QueryGraph = FTerrainLayerGraph(TerrainParameters, BiomesParameters, *LayerSettings);
+		QueryParametersHash = ParametersHash;
+		QueryChunkSize = Size;
+	}
+
+	for (const FChunkGenerationRequest& Request : Requests)
+	{
+		UE_LOG(LogPTGChunk, Verbose, TEXT("Starting chunk generation at X: %d, Y: %d, LOD %d"), Request.X, Request.Y, Request.LOD);
+
+		FChunk NewChunk;
+		NewChunk.Size = Size;
+		NewChunk.LOD = Request.LOD;
+		NewChunk.Coords = FVector(Request.X, Request.Y, 0);
+		NewChunk.Id = ChunkData::GetChunkIdFromCoordinates(Request.X, Request.Y);
+		NewChunk.ParametersHash = ParametersHash;
+
+		const FChunk* ExistingChunk = ChunkMap.Find(NewChunk.Id);
+		if (!ExistingChunk || !ExistingChunk->IsGenerated())
+		{
+			ChunkMap.Add(NewChunk.Id, NewChunk);
+		}
+
+		// A previous request for the same chunk is superseded by this one
+		CancelChunkGeneration(NewChunk.Id);
 
-	ChunkMap.Add(NewChunk.Id, NewChunk);
-	FChunkThread* Thread = new FChunkThread(NewChunk, TerrainParameters,BiomesParameters);
-	Thread->OnCalcOver.AddUObject(this, &UTerrainGeneratorWorldSubsystem::OnChunkCalcOver);
+		FChunkJobRef Job = MakeShared<FChunkJob, ESPMode::ThreadSafe>(NewChunk, TerrainParameters, BiomesParameters, Request.Priority);
+		Job->Topology = MeshGenerator ? MeshGenerator->GetChunkTopology(Size, Request.LOD, bSkirts) : nullptr;
+		Job->SkirtDepth = SkirtDepth;
+		Job->DiskCache = DiskCache;
+		Job->LayerSettings = LayerSettings;
+		if (StartupSnapshot.IsValid() && StartupSnapshot->Contains(NewChunk))
+		{
+			Job->Snapshot = StartupSnapshot;
+		}
+		CopyNeighborBorders(*Job);
+		PendingJobs.Add(NewChunk.Id, Job);
+		Jobs.Add(Job);
+	}
+
+	if (!CanGenerateOnGPU(TerrainParameters))
+	{
+		Scheduler->EnqueueBatch(Jobs);
+		return;
+	}
+
+	// Baked and cached chunks only need their mesh, they go straight to the workers
+	TArray<FChunkJobRef, TInlineAllocator<16>> StoredJobs;
+	for (int32 i = Jobs.Num() - 1; i >= 0; i--)
+	{
+		const FChunkJobRef& Job = Jobs[i];
+		if (Job->Snapshot.IsValid() || (DiskCache.IsValid() && DiskCache->Contains(Job->Chunk, ParametersHash)))
+		{
+			StoredJobs.Add(Job);
+			Jobs.RemoveAt(i, 1, EAllowShrinking::No);
+		}
+	}
+	if (StoredJobs.Num() > 0)
+	{
+		Scheduler->EnqueueBatch(StoredJobs);
+	}
+
+	// A dispatch samples every chunk with the same step and resolution
+	Jobs.StableSort([](const FChunkJobRef& A, const FChunkJobRef& B) { return A->Chunk.LOD < B->Chunk.LOD; });
+	for (int32 First = 0; First < Jobs.Num();)
+	{
+		int32 Last = First + 1;
+		while (Last < Jobs.Num() && Last - First < MaxChunksPerGPUDispatch && Jobs[Last]->Chunk.LOD == Jobs[First]->Chunk.LOD)
+		{
+			Last++;
+		}
+		DispatchGPUBatch(MakeArrayView(Jobs.GetData() + First, Last - First));
+		First = Last;
+	}
+}
+
+/**
+ * @brief Integrates chunks finished by the workers
+ * @param Deadline FPlatformTime::Seconds() value after which no further chunk is integrated
+ * @return Number of chunks integrated
+ * @details At least one chunk is integrated per call so streaming always progresses
+ */
+int32 UTerrainGeneratorWorldSubsystem::ProcessCompletedChunks(double Deadline)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTerrainGeneratorWorldSubsystem::ProcessCompletedChunks);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_ProcessCompletedChunks);
+
+	ProcessGPUBatches();
+
+	int32 ProcessedChunks = 0;
+	FChunkJobPtr Job;
+
+	while ((ProcessedChunks == 0 || FPlatformTime::Seconds() < Deadline) && Scheduler->DequeueCompletedJob(Job))
+	{
+		// Ignore results of jobs cancelled or superseded after they finished
+		const FChunkJobRef* PendingJob = PendingJobs.Find(Job->Chunk.Id);
+		if (Job->IsCancelled() || !PendingJob || *PendingJob != Job.ToSharedRef())
+		{
+			continue;
+		}
+
+		// The job is dropped afterwards, its chunk is moved rather than copied
+		const int64 ChunkId = Job->Chunk.Id;
+		if (Job->MeshData.IsValid())
+		{
+			ReadyMeshData.Add(ChunkId, MoveTemp(Job->MeshData));
+		}
+		OnChunkCalcOver(ChunkId, MoveTemp(Job->Chunk));
+
+		// Listeners display chunks on completion, data of a chunk left hidden would go stale
+		ReadyMeshData.Remove(ChunkId);
+		ProcessedChunks++;
+	}
+
+	return ProcessedChunks;
+}
+
+/**
+ * @brief Cancels a queued or running chunk generation
+ * @param ChunkId Unique identifier of chunk whose generation is cancelled
+ * @return True if a pending generation was cancelled
+ */
+bool UTerrainGeneratorWorldSubsystem::CancelChunkGeneration(int64 ChunkId)
+{
+	if (const FChunkJobRef* PendingJob = PendingJobs.Find(ChunkId))
+	{
+		FChunkJobRef Job = *PendingJob;
+		PendingJobs.Remove(ChunkId);
+		Scheduler->Cancel(Job);
+		return true;
+	}
+	return false;
 }
 
 /**
@@ -72,7 +290,7 @@ void UTerrainGeneratorWorldSubsystem::DisplayChunk(int64 ChunkId)
 	}
 	else
 	{
-		UE_LOG(LogTemp, Error, TEXT("Chunk %lld not found in map"), ChunkId);
+		UE_LOG(LogPTG, Error, TEXT("Chunk %lld not found in map"), ChunkId);
 	}
 }
 
@@ -80,50 +298,601 @@ void UTerrainGeneratorWorldSubsystem::DisplayChunk(int64 ChunkId)
  * @brief Removes a chunk from the world
  * @param ChunkId Unique identifier of chunk to destroy
  * @return True if chunk was successfully destroyed
+ * @details A chunk still being generated has its job cancelled, its sections are cleared and
+ *          the mesh actor is returned to the pool once no chunk uses it. Its memory is no longer accounted
  */
 bool UTerrainGeneratorWorldSubsystem::DestroyChunk(int64 ChunkId)
 {
-	if (MeshMap.Find(ChunkId) && ChunkMap.Find(ChunkId))
+	CancelChunkGeneration(ChunkId);
+	CollisionChunks.Remove(ChunkId);
+
+	AActor* Mesh = nullptr;
+	const FChunk* Chunk = ChunkMap.Find(ChunkId);
+	if (MeshMap.RemoveAndCopyValue(ChunkId, Mesh) && Mesh && Chunk)
 	{
-		AActor* Mesh = MeshMap.FindAndRemoveChecked(ChunkId);
-		UProceduralMeshComponent* ProceduralMesh = Mesh->FindComponentByClass<UProceduralMeshComponent>();
-		ProceduralMesh->ClearMeshSection(0);
-		Mesh->Destroy();
-		return ChunkMap.Remove(ChunkId) > 0;
+		ReleaseChunkMeshOwner(*Chunk, Mesh);
 	}
-	return false;
+
+	FChunkMemoryUsage Usage;
+	if (ChunkMemory.RemoveAndCopyValue(ChunkId, Usage))
+	{
+		ResidentMemory -= Usage;
+	}
+	return ChunkMap.Remove(ChunkId) > 0;
 }
 
 /**
  * @brief Callback handler for chunk calculation completion
  * @param _id Identifier of completed chunk
- * @param _chunk Data of completed chunk
+ * @param _chunk Data of completed chunk, moved into the chunk map
  */
-void UTerrainGeneratorWorldSubsystem::OnChunkCalcOver(int64 _id, FChunk _chunk)
+void UTerrainGeneratorWorldSubsystem::OnChunkCalcOver(int64 _id, FChunk&& _chunk)
 {
 	FChunk* chunk = ChunkMap.Find(_id);
+	PendingJobs.Remove(_id);
 	
 	if (chunk)
 	{
-		ChunkMap.Add(_id, _chunk);
-		UE_LOG(LogTemp, Warning, TEXT("Generating Chunk Soone to Display"));
+		*chunk = MoveTemp(_chunk);
+
+		FChunkMemoryUsage Usage = GetChunkMemory(_id);
+		Usage.HeightBytes = chunk->HeightData.IsValid() ? sizeof(FChunkHeights) + chunk->HeightData->Values.GetAllocatedSize() : 0;
+		SetChunkMemory(_id, Usage);
+
+		UE_LOG(LogPTGChunk, Verbose, TEXT("Chunk %lld generated"), _id);
 		OnChunkGenerationComplete.Broadcast(_id);
 	}
 }
 
+/**
+ * @brief Enables or disables the collision of a chunk
+ * @param ChunkId Unique identifier of the chunk, it may not be generated yet
+ * @param bEnabled Whether the chunk cooks collision
+ * @details Displayed chunks get their collision section right away, others when they are displayed.
+ *          Render only chunks have no collision section at all
+ */
+void UTerrainGeneratorWorldSubsystem::SetChunkCollision(int64 ChunkId, bool bEnabled)
+{
+	AActor* const* MeshOwner = MeshMap.Find(ChunkId);
+	const FChunk* Chunk = ChunkMap.Find(ChunkId);
+
+	if (!bEnabled)
+	{
+		if (CollisionChunks.Remove(ChunkId) > 0 && MeshOwner && IsValid(*MeshOwner) && Chunk)
+		{
+			if (UProceduralMeshComponent* ProceduralMesh = (*MeshOwner)->FindComponentByClass<UProceduralMeshComponent>())
+			{
+				ProceduralMesh->ClearMeshSection(GetCollisionSectionIndex(*Chunk));
+			}
+		}
+
+		if (ChunkMemory.Contains(ChunkId))
+		{
+			FChunkMemoryUsage Usage = GetChunkMemory(ChunkId);
+			Usage.CollisionBytes = 0;
+			SetChunkMemory(ChunkId, Usage);
+		}
+		return;
+	}
+
+	bool bAlreadyEnabled = false;
+	CollisionChunks.Add(ChunkId, &bAlreadyEnabled);
+
+	if (!bAlreadyEnabled && MeshOwner && Chunk && Chunk->IsGenerated())
+	{
+		UpdateChunkCollision(*Chunk, *MeshOwner);
+	}
+}
+
+/**
+ * @brief Sets the number of chunks per side of the render regions
+ * @param _regionSize Chunks per region side, 1 gives every chunk its own actor
+ * @details Only applied while no chunk is displayed. Pooled actors are destroyed as their sections follow the previous layout
+ */
+void UTerrainGeneratorWorldSubsystem::SetRegionSize(int32 _regionSize)
+{
+	const int32 NewRegionSize = FMath::Clamp(_regionSize, 1, 8);
+	if (NewRegionSize == RegionSize)
+	{
+		return;
+	}
+
+	if (MeshMap.Num() > 0)
+	{
+		UE_LOG(LogPTG, Warning, TEXT("Region size can only change while no chunk is displayed, keeping %d"), RegionSize);
+		return;
+	}
+
+	EmptyMeshActorPool();
+	RegionSize = NewRegionSize;
+}
+
+/**
+ * @brief Returns the level of detail a chunk is generated or being generated at
+ * @param ChunkId Unique identifier of the chunk
+ * @return LOD of the pending generation if any, else of the stored chunk, INDEX_NONE when unknown
+ */
+int32 UTerrainGeneratorWorldSubsystem::GetRequestedChunkLOD(int64 ChunkId) const
+{
+	if (const FChunkJobRef* PendingJob = PendingJobs.Find(ChunkId))
+	{
+		return (*PendingJob)->Chunk.LOD;
+	}
+	if (const FChunk* Chunk = ChunkMap.Find(ChunkId))
+	{
+		return Chunk->LOD;
+	}
+	return INDEX_NONE;
+}
+
+/**
+ * @brief Returns the parameters a chunk is generated or being generated with
+ * @param ChunkId Unique identifier of the chunk
+ * @return Parameters hash of the pending generation if any, else of the stored chunk, 0 when unknown
+ */
+uint32 UTerrainGeneratorWorldSubsystem::GetRequestedChunkParametersHash(int64 ChunkId) const
+{
+	if (const FChunkJobRef* PendingJob = PendingJobs.Find(ChunkId))
+	{
+		return (*PendingJob)->Chunk.ParametersHash;
+	}
+	if (const FChunk* Chunk = ChunkMap.Find(ChunkId))
+	{
+		return Chunk->ParametersHash;
+	}
+	return 0;
+}
+
+/**
+ * @brief Estimates the memory the pending generations will add
+ * @return Bytes of the heights and render meshes of the queued and running jobs, collision is accounted once cooked
+ */
+uint64 UTerrainGeneratorWorldSubsystem::GetPendingMemoryEstimate() const
+{
+	uint64 Bytes = 0;
+	for (const auto& JobPair : PendingJobs)
+	{
+		const FChunk& Chunk = JobPair.Value->Chunk;
+		const bool bSkirts = JobPair.Value->Topology.IsValid() && JobPair.Value->Topology->bSkirts;
+		Bytes += UProceduralMeshGeneratorSubsystem::EstimateChunkMemory(Chunk.Size, Chunk.LOD, bSkirts).GetTotal();
+	}
+	return Bytes;
+}
+
+/**
+ * @brief Returns the memory held by the chunk bookkeeping
+ * @return Allocated bytes of the chunk, mesh, job and region maps
+ */
+uint64 UTerrainGeneratorWorldSubsystem::GetContainerMemory() const
+{
+	return ChunkMap.GetAllocatedSize() + MeshMap.GetAllocatedSize() + PendingJobs.GetAllocatedSize() + ReadyMeshData.GetAllocatedSize()
+		+ CollisionChunks.GetAllocatedSize() + RegionMap.GetAllocatedSize() + ChunkMemory.GetAllocatedSize() + MeshActorPool.GetAllocatedSize();
+}
+
+/**
+ * @brief Replaces the accounted memory of a chunk
+ * @param ChunkId Unique identifier of the chunk
+ * @param Usage Bytes the chunk now holds
+ */
+void UTerrainGeneratorWorldSubsystem::SetChunkMemory(int64 ChunkId, const FChunkMemoryUsage& Usage)
+{
+	FChunkMemoryUsage& ChunkUsage = ChunkMemory.FindOrAdd(ChunkId);
+	ResidentMemory -= ChunkUsage;
+	ResidentMemory += Usage;
+	ChunkUsage = Usage;
+}
+
+/**
+ * @brief Returns the terrain height at a world position
+ * @param WorldPosition Position on the XY plane in world units
+ * @param OutNormal Terrain normal at the position, optional
+ * @return Height in world units, 0 before any chunk has been requested
+ * @details Loaded chunks are bilinearly interpolated, elsewhere the noise is evaluated directly.
+ *          Chunks only change in ProcessCompletedChunks, so every query of a frame sees the same terrain
+ */
+float UTerrainGeneratorWorldSubsystem::QueryHeight(const FVector2D& WorldPosition, FVector* OutNormal) const
+{
+	const FChunk* Chunk = nullptr;
+	return QueryHeightInternal(WorldPosition, OutNormal, Chunk);
+}
+
+/**
+ * @brief Returns the terrain height at many world positions
+ * @param WorldPositions Positions on the XY plane in world units
+ * @param OutHeights Heights in world units, as many as WorldPositions
+ * @param OutNormals Terrain normals, empty or as many as WorldPositions
+ * @details Positions are processed in blocks on the task graph, each block remembers the last chunk it hit
+ *          so nearby positions skip the chunk lookup
+ */
+void UTerrainGeneratorWorldSubsystem::QueryHeights(TConstArrayView<FVector2D> WorldPositions, TArrayView<float> OutHeights, TArrayView<FVector> OutNormals) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTerrainGeneratorWorldSubsystem::QueryHeights);
+	check(OutHeights.Num() == WorldPositions.Num());
+	check(OutNormals.Num() == 0 || OutNormals.Num() == WorldPositions.Num());
+
+	constexpr int32 QueriesPerBlock = 256;
+	const int32 NumBlocks = FMath::DivideAndRoundUp(WorldPositions.Num(), QueriesPerBlock);
+
+	ParallelFor(NumBlocks, [this, WorldPositions, OutHeights, OutNormals](int32 Block)
+	{
+		const FChunk* Chunk = nullptr;
+		const int32 Last = FMath::Min((Block + 1) * QueriesPerBlock, WorldPositions.Num());
+		for (int32 i = Block * QueriesPerBlock; i < Last; i++)
+		{
+			OutHeights[i] = QueryHeightInternal(WorldPositions[i], OutNormals.Num() > 0 ? &OutNormals[i] : nullptr, Chunk);
+		}
+	}, NumBlocks > 1 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+/**
+ * @brief Applies the worker pool configuration
+ * @param NumWorkers Number of workers, 0 uses one per available core
+ * @param Priority Priority of the worker threads
+ * @details The pool is only resized while no generation is pending, the priority is always applied
+ */
+void UTerrainGeneratorWorldSubsystem::ConfigureWorkers(int32 NumWorkers, EChunkWorkerPriority Priority)
+{
+	const int32 WorkerCount = NumWorkers > 0 ? NumWorkers : FChunkScheduler::GetDefaultWorkerCount();
+	const EThreadPriority ThreadPriority = FChunkScheduler::ToThreadPriority(Priority);
+
+	if (Scheduler && (Scheduler->GetNumWorkers() == WorkerCount || PendingJobs.Num() > 0))
+	{
+		Scheduler->SetThreadPriority(ThreadPriority);
+		return;
+	}
+
+	Scheduler = MakeUnique<FChunkScheduler>(WorkerCount, ThreadPriority);
+}
+
+/**
+ * @brief Enables or disables the disk cache of generated heights
+ * @param bEnabled Whether jobs look up and store their heights in the cache
+ * @param bCompress Whether new entries are LZ4 compressed
+ * @details Jobs already dispatched keep the cache they were given
+ */
+void UTerrainGeneratorWorldSubsystem::ConfigureDiskCache(bool bEnabled, bool bCompress)
+{
+	if (!bEnabled)
+	{
+		DiskCache.Reset();
+		return;
+	}
+
+	DiskCache = MakeShared<FChunkDiskCache, ESPMode::ThreadSafe>(FChunkDiskCache::GetDefaultDirectory(), bCompress);
+}
+
+/**
+ * @brief Tells whether chunks generated with the given parameters are sent to the compute shader
+ * @param Parameters Terrain noise parameters
+ * @return True with the GPU backend selected, a hashed noise version, no noise layer and a renderer able to run it
+ * @details The legacy gradients come from std::mt19937 and only exist on the CPU, the shader only evaluates the base height.
+ *          The layers are read from the graph compiled for the current request
+ */
+bool UTerrainGeneratorWorldSubsystem::CanGenerateOnGPU(const FPerlinParameters& Parameters) const
+{
+	return GenerationBackend == EChunkGenerationBackend::GPU && Parameters.Version != EPerlinNoiseVersion::Legacy
+		&& QueryGraph.IsBaseOnly() && FTerrainNoiseComputeBatch::IsSupported();
+}
+
+/**
+ * @brief Sends the heights of a batch of jobs to the compute shader
+ * @param Jobs Pending jobs sharing the same chunk size, LOD and noise parameters
+ */
+void UTerrainGeneratorWorldSubsystem::DispatchGPUBatch(TConstArrayView<FChunkJobRef> Jobs)
+{
+	const FChunk& Chunk = Jobs[0]->Chunk;
+	const FPerlinParameters& Parameters = Jobs[0]->Parameters;
+	const FTerrainLayerSettings& Layers = *Jobs[0]->LayerSettings;
+
+	FTerrainNoiseDispatchParameters DispatchParameters;
+	DispatchParameters.ChunkSize = Chunk.Size;
+	DispatchParameters.SampleStep = Chunk.GetSampleStep();
+	DispatchParameters.Resolution = Chunk.GetResolution();
+	DispatchParameters.Octaves = Parameters.Octaves;
+	DispatchParameters.Frequency = Parameters.Frequency;
+	DispatchParameters.Persistence = Parameters.Persistence;
+	DispatchParameters.Seed = Parameters.Seed;
+	DispatchParameters.bAnalyticDerivative = Parameters.Version == EPerlinNoiseVersion::HashedAnalytic;
+	DispatchParameters.GradientPower = Layers.GradientPower;
+	DispatchParameters.GradientSmoothing = Layers.GradientSmoothing;
+	DispatchParameters.Epsilon = FTerrainLayerGraph::SmoothingEpsilon.X;
+	DispatchParameters.HeightScale = Layers.HeightScale;
+	DispatchParameters.Gradients = TArray<FVector2f>(UPerlinNoise::GetGradientTable(), UPerlinNoise::GradientTableSize);
+
+	FGPUChunkBatch& Batch = GPUBatches.AddDefaulted_GetRef();
+	Batch.Jobs = Jobs;
+	for (const FChunkJobRef& Job : Jobs)
+	{
+		DispatchParameters.ChunkOrigins.Add(FIntPoint((int32)Job->Chunk.Coords.X, (int32)Job->Chunk.Coords.Y));
+	}
+
+	Batch.Batch = MakeShared<FTerrainNoiseComputeBatch, ESPMode::ThreadSafe>();
+	Batch.Batch->Dispatch(MoveTemp(DispatchParameters));
+
+	UE_LOG(LogPTGChunk, Verbose, TEXT("Dispatched %d chunks to the GPU at LOD %d"), Jobs.Num(), Chunk.LOD);
+}
+
+/**
+ * @brief Hands the jobs of read back compute batches to the workers
+ * @details Heights are applied on the game thread, the workers skip the noise stage of jobs already generated.
+ *          Jobs cancelled meanwhile are dropped, a batch that failed falls back to the CPU
+ */
+void UTerrainGeneratorWorldSubsystem::ProcessGPUBatches()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTerrainGeneratorWorldSubsystem::ProcessGPUBatches);
+
+	for (int32 BatchIndex = 0; BatchIndex < GPUBatches.Num();)
+	{
+		FGPUChunkBatch& Batch = GPUBatches[BatchIndex];
+		if (!Batch.Batch->Poll())
+		{
+			BatchIndex++;
+			continue;
+		}
+
+		TArray<FChunkJobRef, TInlineAllocator<16>> ReadyJobs;
+		for (int32 i = 0; i < Batch.Jobs.Num(); i++)
+		{
+			const FChunkJobRef& Job = Batch.Jobs[i];
+			if (Job->IsCancelled())
+			{
+				continue;
+			}
+
+			const TConstArrayView<float> Grid = Batch.Batch->GetChunkHeights(i);
+			if (Grid.Num() > 0)
+			{
+				ApplyComputedHeights(*Job, Grid, Batch.Batch->GetGridResolution());
+			}
+			ReadyJobs.Add(Job);
+		}
+
+		Scheduler->EnqueueBatch(ReadyJobs);
+		GPUBatches.RemoveAt(BatchIndex);
+	}
+}
+
+/**
+ * @brief Height query of a single position
+ * @param WorldPosition Position on the XY plane in world units
+ * @param OutNormal Terrain normal at the position, optional
+ * @param InOutChunk Chunk of the previous query, tested first and replaced by the loaded chunk holding the position
+ * @return Height in world units
+ */
+float UTerrainGeneratorWorldSubsystem::QueryHeightInternal(const FVector2D& WorldPosition, FVector* OutNormal, const FChunk*& InOutChunk) const
+{
+	if (QueryChunkSize < 2)
+	{
+		if (OutNormal)
+		{
+			*OutNormal = FVector::UpVector;
+		}
+		return 0.0f;
+	}
+
+	const FVector2D SamplePosition = WorldPosition / 100.0;
+	const int32 ChunkSpan = QueryChunkSize - 1;
+	const int32 OriginX = FMath::FloorToInt(SamplePosition.X / ChunkSpan) * ChunkSpan;
+	const int32 OriginY = FMath::FloorToInt(SamplePosition.Y / ChunkSpan) * ChunkSpan;
+
+	if (!InOutChunk || InOutChunk->Coords.X != OriginX || InOutChunk->Coords.Y != OriginY)
+	{
+		const FChunk* Chunk = ChunkMap.Find(ChunkData::GetChunkIdFromCoordinates(OriginX, OriginY));
+		InOutChunk = Chunk && Chunk->Size == QueryChunkSize && Chunk->IsGenerated() ? Chunk : nullptr;
+	}
+
+	float Height = 0.0f;
+	FVector2f Gradient = FVector2f::ZeroVector;
+	if (InOutChunk)
+	{
+		Height = InOutChunk->SampleHeight(SamplePosition.X - OriginX, SamplePosition.Y - OriginY, OutNormal ? &Gradient : nullptr);
+	}
+	else
+	{
+		// Same layer graph as FChunkThread::GenerateChunk
+		auto EvaluateNoise = [this](double X, double Y)
+		{
+			return QueryGraph.EvaluateHeight(X, Y);
+		};
+
+		Height = EvaluateNoise(SamplePosition.X, SamplePosition.Y);
+		if (OutNormal)
+		{
+			// One sample apart, the slope a full resolution chunk would have
+			Gradient = FVector2f(EvaluateNoise(SamplePosition.X + 1.0, SamplePosition.Y) - Height, EvaluateNoise(SamplePosition.X, SamplePosition.Y + 1.0) - Height);
+		}
+	}
+
+	if (OutNormal)
+	{
+		// Samples are 100 units apart
+		*OutNormal = FVector(-Gradient.X / 100.0f, -Gradient.Y / 100.0f, 1.0f).GetSafeNormal();
+	}
+	return Height;
+}
+
+/**
+ * @brief Copies the edges a job shares with already generated neighbors
+ * @param Job Job whose BorderHeights and ApronHeights are filled
+ * @details Chunks overlap by one row and one column, so the first row of a chunk is the last row of its southern neighbor
+ *          and the row below it is the apron. Only neighbors at the same LOD and generated with the same parameters share
+ *          their samples, aprons are only grid rows of the neighbor when the LOD step divides the chunk size
+ */
+void UTerrainGeneratorWorldSubsystem::CopyNeighborBorders(FChunkJob& Job) const
+{
+	const int32 Size = Job.Chunk.Size;
+	const int32 Step = Size - 1;
+	const int32 Resolution = Job.Chunk.GetResolution();
+	const int32 Last = Resolution - 1;
+	const bool bCopyAprons = Job.Chunk.IsRegularGrid() && Resolution > 2;
+	const int32 X = Job.Chunk.Coords.X;
+	const int32 Y = Job.Chunk.Coords.Y;
+
+	struct FNeighborEdge
+	{
+		EChunkBorder Border;
+		int32 OffsetX;
+		int32 OffsetY;
+		int32 FirstIndex;
+		int32 ApronFirstIndex;
+		int32 IndexStride;
+	};
+	const FNeighborEdge Edges[] =
+	{
+		{ EChunkBorder::South, 0, -Step, Last * Resolution, (Last - 1) * Resolution, 1 },
+		{ EChunkBorder::North, 0, Step, 0, Resolution, 1 },
+		{ EChunkBorder::West, -Step, 0, Last, Last - 1, Resolution },
+		{ EChunkBorder::East, Step, 0, 0, 1, Resolution },
+	};
+
+	for (const FNeighborEdge& Edge : Edges)
+	{
+		const int64 NeighborId = ChunkData::GetChunkIdFromCoordinates(X + Edge.OffsetX, Y + Edge.OffsetY);
+		const FChunk* Neighbor = ChunkMap.Find(NeighborId);
+		if (!Neighbor || Neighbor->Size != Size || Neighbor->LOD != Job.Chunk.LOD || Neighbor->ParametersHash != Job.Chunk.ParametersHash
+			|| !Neighbor->IsGenerated() || PendingJobs.Contains(NeighborId))
+		{
+			continue;
+		}
+
+		const TArray<float>& NeighborHeights = Neighbor->GetHeights();
+		TArray<float>& BorderHeights = Job.BorderHeights[(int32)Edge.Border];
+		TArray<float>& ApronHeights = Job.ApronHeights[(int32)Edge.Border];
+		BorderHeights.SetNumUninitialized(Resolution);
+		for (int32 i = 0; i < Resolution; i++)
+		{
+			BorderHeights[i] = NeighborHeights[Edge.FirstIndex + i * Edge.IndexStride];
+		}
+
+		if (bCopyAprons)
+		{
+			ApronHeights.SetNumUninitialized(Resolution);
+			for (int32 i = 0; i < Resolution; i++)
+			{
+				ApronHeights[i] = NeighborHeights[Edge.ApronFirstIndex + i * Edge.IndexStride];
+			}
+		}
+	}
+}
+
+/**
+ * @brief Takes a chunk mesh actor from the pool, spawning one when the pool is empty
+ * @return Visible actor owning a procedural mesh component with the terrain material
+ * @details Pooled actors keep their last mesh section so a chunk of the same layout only updates its buffers
+ */
+AActor* UTerrainGeneratorWorldSubsystem::AcquireMeshActor()
+{
+	while (MeshActorPool.Num() > 0)
+	{
+		AActor* PooledMesh = MeshActorPool.Pop(EAllowShrinking::No);
+		if (IsValid(PooledMesh))
+		{
+			if (UProceduralMeshComponent* ProceduralMesh = PooledMesh->FindComponentByClass<UProceduralMeshComponent>())
+			{
+				PooledMeshBytes -= FMath::Min(PooledMeshBytes, UProceduralMeshGeneratorSubsystem::GetMeshMemory(ProceduralMesh));
+				ProceduralMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+			}
+			PooledMesh->SetActorHiddenInGame(false);
+			return PooledMesh;
+		}
+	}
+
+	AActor* MeshOwner = GetWorld()->SpawnActor<AActor>();
+
+	// Create the procedural mesh component with the actor as its owner
+	UProceduralMeshComponent* ProceduralMesh = NewObject<UProceduralMeshComponent>(
+		MeshOwner,  // Set the owner to our newly created actor
+		UProceduralMeshComponent::StaticClass(),
+		NAME_None,
+		RF_Transient
+	);
+
+	// Collision sections are cooked off the game thread
+	ProceduralMesh->bUseAsyncCooking = true;
+
+	// Attach the component to the actor's root
+	ProceduralMesh->SetupAttachment(MeshOwner->GetRootComponent());
+	ProceduralMesh->RegisterComponent();
+	
+	if (Material) 
+	{
+		ProceduralMesh->SetMaterial(0, Material);
+	}
+
+	return MeshOwner;
+}
+
+/**
+ * @brief Returns a chunk mesh actor to the pool
+ * @param Mesh Actor no longer used by any chunk
+ * @details The actor is hidden and its collision disabled, its remaining mesh sections are kept for the next chunk
+ *          and accounted as pooled memory. Actors beyond MaxPooledMeshActors are destroyed
+ */
+void UTerrainGeneratorWorldSubsystem::ReleaseMeshActor(AActor* Mesh)
+{
+	if (!IsValid(Mesh))
+	{
+		return;
+	}
+
+	if (MeshActorPool.Num() >= MaxPooledMeshActors)
+	{
+		DestroyMeshActor(Mesh);
+		return;
+	}
+
+	if (UProceduralMeshComponent* ProceduralMesh = Mesh->FindComponentByClass<UProceduralMeshComponent>())
+	{
+		PooledMeshBytes += UProceduralMeshGeneratorSubsystem::GetMeshMemory(ProceduralMesh);
+		ProceduralMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+	Mesh->SetActorHiddenInGame(true);
+	MeshActorPool.Add(Mesh);
+}
+
+/**
+ * @brief Clears and destroys a chunk mesh actor
+ * @param Mesh Actor to destroy
+ */
+void UTerrainGeneratorWorldSubsystem::DestroyMeshActor(AActor* Mesh)
+{
+	if (!IsValid(Mesh))
+	{
+		return;
+	}
+
+	if (UProceduralMeshComponent* ProceduralMesh = Mesh->FindComponentByClass<UProceduralMeshComponent>())
+	{
+		ProceduralMesh->ClearAllMeshSections();
+	}
+	Mesh->Destroy();
+}
+
+/**
+ * @brief Destroys every pooled mesh actor
+ * @details Frees the sections they kept, the next chunks displayed spawn new actors
+ */
+void UTerrainGeneratorWorldSubsystem::EmptyMeshActorPool()
+{
+	for (AActor* PooledMesh : MeshActorPool)
+	{
+		DestroyMeshActor(PooledMesh);
+	}
+	MeshActorPool.Empty();
+	PooledMeshBytes = 0;
+}
+
 /**
  * @brief Internal method to handle chunk mesh creation and display
  * @param Chunk Data of chunk to display
- * @details Creates procedural mesh component and applies materials
+ * @details Reuses the chunk mesh actor or the one of its region, else takes one from the pool, then uploads the mesh
+ *          to the section of the chunk
  */
 void UTerrainGeneratorWorldSubsystem::DisplayChunkInternal(const FChunk& Chunk)
 {
-	FGenerationStats& Stats = GenerationStats.Add(Chunk.Id);
-	Stats.StartTime = FPlatformTime::Seconds();
-	Stats.ChunkSize = Chunk.Size;
-	Stats.VertexCount = Chunk.Size * Chunk.Size;
-	Stats.TriangleCount = (Chunk.Size - 1) * (Chunk.Size - 1) * 2;
-	
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTerrainGeneratorWorldSubsystem::DisplayChunkInternal);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_DisplayChunk);
+
 	AActor* MeshOwner = nullptr;
 	if (AActor* const* ExistingMeshOwner = MeshMap.Find(Chunk.Id))
 	{
@@ -131,45 +900,145 @@ void UTerrainGeneratorWorldSubsystem::DisplayChunkInternal(const FChunk& Chunk)
 	}
 	else
 	{
-		MeshOwner = GetWorld()->SpawnActor<AActor>();
+		MeshOwner = AcquireChunkMeshOwner(Chunk);
+		MeshMap.Emplace(Chunk.Id, MeshOwner);
+	}
 
-		// Create the procedural mesh component with the actor as its owner
-		UProceduralMeshComponent* ProceduralMesh = NewObject<UProceduralMeshComponent>(
-			MeshOwner,  // Set the owner to our newly created actor
-			UProceduralMeshComponent::StaticClass(),
-			NAME_None,
-			RF_Transient
-		);
+	UProceduralMeshComponent* ProceduralMesh = MeshOwner->FindComponentByClass<UProceduralMeshComponent>();
+	const int32 SectionIndex = GetRenderSectionIndex(Chunk);
 
-		// Attach the component to the actor's root
-		ProceduralMesh->SetupAttachment(MeshOwner->GetRootComponent());
-		ProceduralMesh->RegisterComponent();
-		
-		if (Material) 
-		{
-			ProceduralMesh->SetMaterial(0, Material);
-		}
-		
-		MeshMap.Emplace(Chunk.Id, MeshOwner);
+	// Region sections past the first get the terrain material when first used
+	if (Material && ProceduralMesh->GetMaterial(SectionIndex) != Material)
+	{
+		ProceduralMesh->SetMaterial(SectionIndex, Material);
 	}
 	
 	if (UProceduralMeshGeneratorSubsystem* MeshGenerator = GetWorld()->GetGameInstance()->GetSubsystem<UProceduralMeshGeneratorSubsystem>())
 	{
-		MeshGenerator->CreateChunkMesh(
-			MeshOwner->FindComponentByClass<UProceduralMeshComponent>(),
-			Chunk,
-			0
-		);
+		// Only the upload is left when the workers already built the mesh
+		FChunkMeshDataPtr MeshData;
+		if (ReadyMeshData.RemoveAndCopyValue(Chunk.Id, MeshData) && MeshData.IsValid())
+		{
+			MeshGenerator->UploadChunkMesh(ProceduralMesh, *MeshData, SectionIndex);
+		}
+		else
+		{
+			MeshGenerator->CreateChunkMesh(
+				ProceduralMesh,
+				Chunk,
+				SectionIndex
+			);
+		}
 	}
 
-	Stats.VertexCount = Chunk.Size * Chunk.Size;
-	Stats.TriangleCount = (Chunk.Size - 1) * (Chunk.Size - 1) * 2;
-	Stats.EndTime = FPlatformTime::Seconds();
-	double GenerationTime = (Stats.EndTime - Stats.StartTime) * 1000;
-	
-	UE_LOG(LogTemp, Warning, TEXT("Chunk %lld Generation Stats:"), Chunk.Id);
-	UE_LOG(LogTemp, Warning, TEXT("  Generation Time: %.2f ms"), GenerationTime);
-	UE_LOG(LogTemp, Warning, TEXT("  Size: %d x %d"), Stats.ChunkSize, Stats.ChunkSize);
-	UE_LOG(LogTemp, Warning, TEXT("  Vertices: %d"), Stats.VertexCount);
-	UE_LOG(LogTemp, Warning, TEXT("  Triangles: %d"), Stats.TriangleCount);
+	FChunkMemoryUsage Usage = GetChunkMemory(Chunk.Id);
+	Usage.MeshBytes = UProceduralMeshGeneratorSubsystem::GetSectionMemory(ProceduralMesh, SectionIndex, false);
+	SetChunkMemory(Chunk.Id, Usage);
+
+	if (CollisionChunks.Contains(Chunk.Id))
+	{
+		UpdateChunkCollision(Chunk, MeshOwner);
+	}
+
+	UE_LOG(LogPTGChunk, Verbose, TEXT("Chunk %lld displayed, %d x %d vertices at LOD %d"), Chunk.Id, Chunk.GetResolution(), Chunk.GetResolution(), Chunk.LOD);
+}
+
+/**
+ * @brief Rebuilds the collision section of a displayed chunk
+ * @param Chunk Generated chunk
+ * @param MeshOwner Actor displaying the chunk
+ * @details Cooking runs asynchronously, the previous collision stays active until the new one is ready
+ */
+void UTerrainGeneratorWorldSubsystem::UpdateChunkCollision(const FChunk& Chunk, AActor* MeshOwner)
+{
+	UProceduralMeshGeneratorSubsystem* MeshGenerator = GetWorld()->GetGameInstance()->GetSubsystem<UProceduralMeshGeneratorSubsystem>();
+	UProceduralMeshComponent* ProceduralMesh = IsValid(MeshOwner) ? MeshOwner->FindComponentByClass<UProceduralMeshComponent>() : nullptr;
+	if (MeshGenerator && ProceduralMesh)
+	{
+		MeshGenerator->CreateChunkCollision(ProceduralMesh, Chunk, CollisionLOD, GetCollisionSectionIndex(Chunk));
+
+		FChunkMemoryUsage Usage = GetChunkMemory(Chunk.Id);
+		Usage.CollisionBytes = UProceduralMeshGeneratorSubsystem::GetSectionMemory(ProceduralMesh, GetCollisionSectionIndex(Chunk), true);
+		SetChunkMemory(Chunk.Id, Usage);
+	}
+}
+
+/**
+ * @brief Computes the render region of a chunk
+ * @param Chunk Chunk to locate
+ * @return Region coordinates, regions are RegionSize chunks wide
+ */
+FIntPoint UTerrainGeneratorWorldSubsystem::GetChunkRegion(const FChunk& Chunk) const
+{
+	const FIntPoint Cell = Chunk.GetCell();
+	return FIntPoint(FMath::FloorToInt((float)Cell.X / RegionSize), FMath::FloorToInt((float)Cell.Y / RegionSize));
+}
+
+/**
+ * @brief Computes the render section of a chunk in its region mesh
+ * @param Chunk Chunk to locate
+ * @return Row-major index of the chunk in its region, 0 without regions
+ */
+int32 UTerrainGeneratorWorldSubsystem::GetRenderSectionIndex(const FChunk& Chunk) const
+{
+	const FIntPoint Local = Chunk.GetCell() - GetChunkRegion(Chunk) * RegionSize;
+	return Local.X + Local.Y * RegionSize;
+}
+
+/**
+ * @brief Returns the actor a newly displayed chunk draws into
+ * @param Chunk Chunk about to be displayed
+ * @return Actor of the chunk region, taken from the pool for the first chunk of the region
+ */
+AActor* UTerrainGeneratorWorldSubsystem::AcquireChunkMeshOwner(const FChunk& Chunk)
+{
+	if (RegionSize <= 1)
+	{
+		return AcquireMeshActor();
+	}
+
+	FChunkRegion& Region = RegionMap.FindOrAdd(GetChunkRegion(Chunk));
+	if (!IsValid(Region.MeshOwner))
+	{
+		Region.MeshOwner = AcquireMeshActor();
+		Region.NumChunks = 0;
+	}
+	Region.NumChunks++;
+	return Region.MeshOwner;
+}
+
+/**
+ * @brief Releases the sections of a chunk leaving the world
+ * @param Chunk Chunk being destroyed
+ * @param MeshOwner Actor the chunk was drawn into
+ * @details The region actor is pooled once its last chunk is gone. Clearing a section of a region rebuilds the proxy
+ *          and the collision of the whole region, see FChunkStreamingSettings::RegionSize.
+ *          Without regions the render section is kept for the next chunk using the pooled actor
+ */
+void UTerrainGeneratorWorldSubsystem::ReleaseChunkMeshOwner(const FChunk& Chunk, AActor* MeshOwner)
+{
+	UProceduralMeshComponent* ProceduralMesh = IsValid(MeshOwner) ? MeshOwner->FindComponentByClass<UProceduralMeshComponent>() : nullptr;
+	if (ProceduralMesh)
+	{
+		ProceduralMesh->ClearMeshSection(GetCollisionSectionIndex(Chunk));
+	}
+
+	if (RegionSize <= 1)
+	{
+		ReleaseMeshActor(MeshOwner);
+		return;
+	}
+
+	if (ProceduralMesh)
+	{
+		ProceduralMesh->ClearMeshSection(GetRenderSectionIndex(Chunk));
+	}
+
+	const FIntPoint RegionCoords = GetChunkRegion(Chunk);
+	FChunkRegion* Region = RegionMap.Find(RegionCoords);
+	if (!Region || --Region->NumChunks <= 0)
+	{
+		RegionMap.Remove(RegionCoords);
+		ReleaseMeshActor(MeshOwner);
+	}
 }
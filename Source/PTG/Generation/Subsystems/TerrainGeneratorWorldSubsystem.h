@@ -4,6 +4,10 @@
 #include "Materials/Material.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "PTG/Generation/Terrain/ChunkData.h"
+#include "PTG/Generation/Terrain/ChunkScheduler.h"
+#include "PTG/Generation/Terrain/TerrainLayerGraph.h"
+#include "PTG/Generation/Terrain/TerrainSnapshot.h"
+#include "PTGShaders/TerrainNoiseCompute.h"
 #include "TerrainGeneratorWorldSubsystem.generated.h"
 
 //////// FORWARD DECLARATION ////////
@@ -24,17 +28,54 @@ public:
 
 	//////// METHODS ////////
 	/// Chunk management
-	void GenerateChunk(int32 X, int32 Y, int32 Size, const FPerlinParameters& Parameters, const FPerlinParameters& BiomesParameters);
+	void GenerateChunk(int32 X, int32 Y, int32 Size, const FPerlinParameters& Parameters, const FPerlinParameters& BiomesParameters, float Priority = 0.0f);
+	void GenerateChunks(TConstArrayView<FChunkGenerationRequest> Requests, int32 Size, const FPerlinParameters& Parameters, const FPerlinParameters& BiomesParameters);
+	bool CancelChunkGeneration(int64 ChunkId);
+	int32 ProcessCompletedChunks(double Deadline);
+
+	/// Workers
+	void ConfigureWorkers(int32 NumWorkers, EChunkWorkerPriority Priority);
+	void ConfigureDiskCache(bool bEnabled, bool bCompress);
 	void DisplayChunk(int64 ChunkId);
 	bool DestroyChunk(int64 ChunkId);
-	void OnChunkCalcOver(int64 _id, FChunk _chunk);
+	void OnChunkCalcOver(int64 _id, FChunk&& _chunk);
+
+	/// Collision
+	void SetChunkCollision(int64 ChunkId, bool bEnabled);
+	bool HasChunkCollision(int64 ChunkId) const { return CollisionChunks.Contains(ChunkId); }
 
 	/// Getters
 	bool HasChunk(int64 ChunkId) const { return ChunkMap.Contains(ChunkId); }
+	bool IsChunkPending(int64 ChunkId) const { return PendingJobs.Contains(ChunkId); }
+	int32 GetPendingChunkCount() const { return PendingJobs.Num(); }
+	int32 GetNumWorkers() const { return Scheduler ? Scheduler->GetNumWorkers() : 0; }
+	int32 GetQueuedJobCount() const { return Scheduler ? Scheduler->GetQueuedJobCount() : 0; }
+	int32 GetInFlightJobCount() const { return Scheduler ? Scheduler->GetInFlightJobCount() : 0; }
 	const FChunk* GetChunk(int64 ChunkId) const { return ChunkMap.Find(ChunkId); }
+	int32 GetRequestedChunkLOD(int64 ChunkId) const;
+	uint32 GetRequestedChunkParametersHash(int64 ChunkId) const;
+
+	/// Memory, measured as chunks are generated, displayed and destroyed
+	const FChunkMemoryUsage& GetResidentMemory() const { return ResidentMemory; }
+	FChunkMemoryUsage GetChunkMemory(int64 ChunkId) const { const FChunkMemoryUsage* Usage = ChunkMemory.Find(ChunkId); return Usage ? *Usage : FChunkMemoryUsage(); }
+	uint64 GetPooledMeshMemory() const { return PooledMeshBytes; }
+	int32 GetPooledMeshActorCount() const { return MeshActorPool.Num(); }
+	uint64 GetPendingMemoryEstimate() const;
+	uint64 GetContainerMemory() const;
+	void EmptyMeshActorPool();
+
+	/// Height queries, game thread
+	float QueryHeight(const FVector2D& WorldPosition, FVector* OutNormal = nullptr) const;
+	void QueryHeights(TConstArrayView<FVector2D> WorldPositions, TArrayView<float> OutHeights, TArrayView<FVector> OutNormals = TArrayView<FVector>()) const;
 
 	/// Setters
 	void SetMaterial(UMaterial* _material) { Material = _material; }
+	void SetSkirtDepth(float _skirtDepth) { SkirtDepth = FMath::Max(_skirtDepth, 0.0f); }
+	void SetCollisionLOD(int32 _collisionLOD) { CollisionLOD = FMath::Clamp(_collisionLOD, 0, 3); }
+	void SetRegionSize(int32 _regionSize);
+	void SetTerrainLayers(const FTerrainLayerSettings& _settings) { LayerSettings = MakeShared<const FTerrainLayerSettings, ESPMode::ThreadSafe>(_settings); }
+	void SetStartupSnapshot(FTerrainSnapshotPtr _snapshot) { StartupSnapshot = _snapshot; }
+	void SetGenerationBackend(EChunkGenerationBackend _backend, int32 _maxChunksPerDispatch) { GenerationBackend = _backend; MaxChunksPerGPUDispatch = FMath::Max(_maxChunksPerDispatch, 1); }
 	
 	//////// DELEGATES IMPLEMENTATION ////////
 	FOnChunkGenerationComplete OnChunkGenerationComplete;
@@ -51,17 +92,84 @@ public:
 
 private:
 	//////// FIELDS ////////
-	/// Stats
-	struct FGenerationStats 
+	/// Generation workers
+	TUniquePtr<FChunkScheduler> Scheduler;
+	TMap<int64, FChunkJobRef> PendingJobs;
+	FChunkDiskCachePtr DiskCache;
+
+	/// Mesh data built by the workers, kept until the chunk is displayed
+	TMap<int64, FChunkMeshDataPtr> ReadyMeshData;
+
+	/// Baked chunks around the spawn, their jobs only build the meshes
+	FTerrainSnapshotPtr StartupSnapshot;
+
+	/// Layer graph of new chunks, shared by their jobs
+	FTerrainLayerSettingsPtr LayerSettings = MakeShared<const FTerrainLayerSettings, ESPMode::ThreadSafe>();
+
+	/// Depth of the skirts added to new chunk meshes, 0 disables them
+	float SkirtDepth = 0.0f;
+
+	/// Chunks cooking collision, their hidden collision section is rebuilt whenever they are displayed
+	TSet<int64> CollisionChunks;
+	int32 CollisionLOD = 1;
+
+	/// Mesh actors shared by the RegionSize² chunks of a region, keyed by region coordinates
+	struct FChunkRegion
 	{
-		double StartTime;
-		double EndTime;
-		int32 ChunkSize;
-		int32 VertexCount;
-		int32 TriangleCount;
+		AActor* MeshOwner = nullptr;
+		int32 NumChunks = 0;
 	};
-	TMap<int64, FGenerationStats> GenerationStats;
+	TMap<FIntPoint, FChunkRegion> RegionMap;
+	int32 RegionSize = 1;
+
+	/// Layer graph of the last generation request, height queries outside loaded chunks evaluate it
+	FTerrainLayerGraph QueryGraph;
+	uint32 QueryParametersHash = 0;
+	int32 QueryChunkSize = 0;
+
+	/// Measured memory of every chunk and their total
+	TMap<int64, FChunkMemoryUsage> ChunkMemory;
+	FChunkMemoryUsage ResidentMemory;
+
+	/// Sections left in the pooled mesh actors
+	uint64 PooledMeshBytes = 0;
+
+	/// Compute noise batches waiting for their readback, their jobs are handed to the workers for the mesh stage
+	struct FGPUChunkBatch
+	{
+		FTerrainNoiseComputeBatchPtr Batch;
+		TArray<FChunkJobRef> Jobs;
+	};
+	TArray<FGPUChunkBatch> GPUBatches;
+	EChunkGenerationBackend GenerationBackend = EChunkGenerationBackend::CPU;
+	int32 MaxChunksPerGPUDispatch = 16;
+
+	/// Hidden chunk mesh actors waiting to be reused, they keep their last mesh section
+	UPROPERTY()
+	TArray<AActor*> MeshActorPool;
+	static constexpr int32 MaxPooledMeshActors = 64;
 
 	//////// METHODS ////////
 	void DisplayChunkInternal(const FChunk& Chunk);
+	void UpdateChunkCollision(const FChunk& Chunk, AActor* MeshOwner);
+	void CopyNeighborBorders(FChunkJob& Job) const;
+	void SetChunkMemory(int64 ChunkId, const FChunkMemoryUsage& Usage);
+	float QueryHeightInternal(const FVector2D& WorldPosition, FVector* OutNormal, const FChunk*& InOutChunk) const;
+
+	/// GPU generation
+	bool CanGenerateOnGPU(const FPerlinParameters& Parameters) const;
+	void DispatchGPUBatch(TConstArrayView<FChunkJobRef> Jobs);
+	void ProcessGPUBatches();
+
+	/// Mesh sections, a chunk owns a render and a collision section of its region mesh
+	FIntPoint GetChunkRegion(const FChunk& Chunk) const;
+	int32 GetRenderSectionIndex(const FChunk& Chunk) const;
+	int32 GetCollisionSectionIndex(const FChunk& Chunk) const { return RegionSize * RegionSize + GetRenderSectionIndex(Chunk); }
+	AActor* AcquireChunkMeshOwner(const FChunk& Chunk);
+	void ReleaseChunkMeshOwner(const FChunk& Chunk, AActor* MeshOwner);
+
+	/// Mesh actor pool
+	AActor* AcquireMeshActor();
+	void ReleaseMeshActor(AActor* Mesh);
+	static void DestroyMeshActor(AActor* Mesh);
 };
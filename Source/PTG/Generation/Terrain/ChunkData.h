@@ -1,25 +1,101 @@
 ﻿#pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
 #include "ChunkData.generated.h"
 
 //////// DELEGATES ////////
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnChunkGenerationComplete, int64);
 
-//////// STRUCTS ////////
-/// Vertices data
-USTRUCT()
-struct FVertices
+//////// ENUMS ////////
+/// Gradient generation scheme of the Perlin noise, worlds only match when generated with the same version
+UENUM(BlueprintType)
+enum class EPerlinNoiseVersion : uint8
 {
-	GENERATED_BODY()
+	/// Gradients drawn from a std::mt19937 seeded per lattice point, kept for existing worlds
+	Legacy,
+	/// Gradients looked up in a fixed table from an integer hash of (x, y, octave, seed)
+	Hashed,
+	/// Hashed gradients, octave smoothing driven by the analytic noise derivative instead of finite differences
+	HashedAnalytic
+};
 
-	UPROPERTY()
-	FVector Coords;
+/// Priority of the chunk generation worker threads
+UENUM(BlueprintType)
+enum class EChunkWorkerPriority : uint8
+{
+	Lowest,
+	BelowNormal,
+	Normal,
+	AboveNormal
+};
 
-	UPROPERTY()
-	FVector Normal;
+/// Processor evaluating the chunk height grids
+UENUM(BlueprintType)
+enum class EChunkGenerationBackend : uint8
+{
+	/// Vectorized noise on the worker threads
+	CPU,
+	/// Compute shader filling a batch of chunks per dispatch, the workers only build the meshes.
+	/// Needs a hashed noise version and shader model 5, other chunks are generated on the CPU
+	GPU
+};
+
+/// Noise a terrain layer is driven by
+UENUM(BlueprintType)
+enum class ETerrainLayerSource : uint8
+{
+	/// Base height noise, shared with the base height at no extra cost
+	Terrain,
+	/// Biome noise, shared with the biome mask at no extra cost
+	Biomes,
+	/// Own noise parameters of the layer
+	Custom
+};
+
+/// Shaping applied to the [0, 1] noise value of a layer
+UENUM(BlueprintType)
+enum class ETerrainLayerShape : uint8
+{
+	/// Noise value as is
+	Smooth,
+	/// 1 - |2v - 1|, sharp crests where the noise crosses its mid value
+	Ridged,
+	/// |2v - 1|, sharp creases where the noise crosses its mid value
+	Billow
+};
+
+/// Operation combining a layer with the height accumulated so far, weighted by the biome mask
+UENUM(BlueprintType)
+enum class ETerrainLayerBlend : uint8
+{
+	Add,
+	Multiply,
+	Max,
+	Min
 };
 
+/// Pixel format of exported heightmaps
+UENUM(BlueprintType)
+enum class EHeightmapFormat : uint8
+{
+	/// 16-bit unsigned heights remapped from the export height range, the landscape import format
+	G16,
+	/// 32-bit float heights in world units, bit identical to the chunk heights
+	R32F
+};
+
+/// Edges of a chunk, South and North are the first and last rows, West and East the first and last columns
+enum class EChunkBorder : uint8
+{
+	South,
+	North,
+	West,
+	East,
+	Count
+};
+
+//////// STRUCTS ////////
 /// Perlin noise parameters
 USTRUCT(Blueprintable)
 struct FPerlinParameters
@@ -40,25 +116,403 @@ struct FPerlinParameters
 
 	UPROPERTY(EditAnywhere)
 	int32 HeightFactor = 0;
+
+	UPROPERTY(EditAnywhere)
+	EPerlinNoiseVersion Version = EPerlinNoiseVersion::Legacy;
+};
+
+/// Noise layer stacked on the base height
+USTRUCT(BlueprintType)
+struct FTerrainNoiseLayer
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ETerrainLayerSource Source = ETerrainLayerSource::Custom;
+
+	/// Only read with a custom source, layers with identical parameters share one noise evaluation
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Source == ETerrainLayerSource::Custom"))
+	FPerlinParameters Noise;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ETerrainLayerShape Shape = ETerrainLayerShape::Smooth;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ETerrainLayerBlend Blend = ETerrainLayerBlend::Add;
+
+	/// Height of the shaped noise in world units, a plain factor with the Multiply blend
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Amplitude = 10000.0f;
+
+	/// How much the biome mask weights the layer, 0 applies it everywhere
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float MaskInfluence = 0.0f;
+
+	/// Applies the layer where the biome mask is low instead
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bInvertMask = false;
+};
+
+/// Graph of noise layers turning the terrain and biome noises into chunk heights.
+/// The default graph is the base height alone, the terrain of worlds generated before layers existed
+USTRUCT(BlueprintType)
+struct FTerrainLayerSettings
+{
+	GENERATED_BODY()
+
+	/// World height of a base noise value of 1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float HeightScale = 100004.0f;
+
+	/// Octave smoothing of every noise of the graph, steeper octaves damp the following ones
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0"))
+	float GradientPower = 3.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float GradientSmoothing = 0.9f;
+
+	/// Biome noise values remapped to a [0, 1] mask with a smooth step, only evaluated when a layer reads the mask
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2f BiomeMaskRange = FVector2f(0.4f, 0.6f);
+
+	/// Applied in order on top of the base height
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FTerrainNoiseLayer> Layers;
+};
+
+typedef TSharedPtr<const FTerrainLayerSettings, ESPMode::ThreadSafe> FTerrainLayerSettingsPtr;
+
+/// Region and format of a heightmap export, pixel (x, y) is the full resolution sample Origin + (x, y) * SampleStep
+USTRUCT(BlueprintType)
+struct FHeightmapExportSettings
+{
+	GENERATED_BODY()
+
+	/// First sample of the image, chunk (X, Y) starts at sample (X, Y) * (ChunkSize - 1)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FIntPoint Origin = FIntPoint::ZeroValue;
+
+	/// Pixels per side
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	FIntPoint Size = FIntPoint(1024, 1024);
+
+	/// Full resolution samples between two pixels, 2^LOD matches the chunks of that LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	int32 SampleStep = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EHeightmapFormat Format = EHeightmapFormat::G16;
+
+	/// World heights written as 0 and 65535 in G16 images, heights outside are clamped
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Format == EHeightmapFormat::G16"))
+	FVector2f HeightRange = FVector2f(0.0f, 100004.0f);
+
+	/// Pixels per side of the tiles evaluated in parallel, files are written a row of tiles at a time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "16"))
+	int32 TileSize = 256;
+};
+
+/// Chunk streaming parameters
+USTRUCT(BlueprintType)
+struct FChunkStreamingSettings
+{
+	GENERATED_BODY()
+
+	/// When disabled, one chunk is dispatched and one destroyed every ChunkOperationInterval
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseFrameBudget = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "!bUseFrameBudget", ClampMin = "0.0"))
+	float ChunkOperationInterval = 0.05f;
+
+	/// Game thread time spent per frame integrating and destroying chunks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bUseFrameBudget", ClampMin = "0.1", Units = "ms"))
+	float FrameBudgetMs = 2.0f;
+
+	/// Upper bound of the budget once frame time headroom is added
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bUseFrameBudget", ClampMin = "0.1", Units = "ms"))
+	float MaxFrameBudgetMs = 8.0f;
+
+	/// Frame time below which the remaining headroom is partly given to streaming
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bUseFrameBudget", ClampMin = "1.0", Units = "ms"))
+	float TargetFrameTimeMs = 16.6f;
+
+	/// Generation requests kept queued or running per worker, new requests are sent in batches to refill it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bUseFrameBudget", ClampMin = "1"))
+	int32 MaxPendingChunksPerWorker = 2;
+
+	/// Number of generation workers, 0 uses one per available core
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 NumWorkers = 0;
+
+	/// Keep below the game thread so generation at full speed never starves it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EChunkWorkerPriority WorkerPriority = EChunkWorkerPriority::BelowNormal;
+
+	/// Generates distant chunks with fewer vertices, each LOD level halving the density
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bEnableLOD = false;
+
+	/// Width in chunks of each LOD ring, measured as the Chebyshev distance to the player chunk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnableLOD", ClampMin = "1"))
+	int32 LODRingWidth = 3;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnableLOD", ClampMin = "0", ClampMax = "3"))
+	int32 MaxLOD = 3;
+
+	/// Depth of the skirts hanging from chunk edges, hides cracks between chunks of different LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnableLOD", ClampMin = "0.0", Units = "cm"))
+	float SkirtDepth = 5000.0f;
+
+	/// Rings of chunks around the player chunk cooking collision, farther chunks are render only
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 CollisionRadius = 1;
+
+	/// Collision meshes take a vertex every 2^CollisionLOD full resolution samples, never finer than the chunk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "3"))
+	int32 CollisionLOD = 1;
+
+	/// Chunks per side of the render regions, each region draws its chunks as sections of one component. 1 draws one actor per chunk.
+	/// Creating or clearing a section rebuilds the scene proxy of the whole region and recooks every collision section in it,
+	/// so streaming a chunk costs about RegionSize x RegionSize chunk uploads and cooks. Only worth it when the primitive count dominates
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1", ClampMax = "8"))
+	int32 RegionSize = 1;
+
+	/// Queues the chunks along the projected path of the player beyond the render window, after every chunk of the window.
+	/// Prefetched chunks are displayed as soon as they are ready and destroyed once the player heads elsewhere
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bEnablePrefetch = false;
+
+	/// Travel time at the current velocity covered by the prefetch, shortened by the share of busy workers
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnablePrefetch", ClampMin = "0.0", Units = "s"))
+	float PrefetchLookaheadSeconds = 3.0f;
+
+	/// Chunks beyond the render window the prefetch may reach
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnablePrefetch", ClampMin = "1"))
+	int32 MaxPrefetchDistance = 4;
+
+	/// Prefetch requests queued at once, nearest first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnablePrefetch", ClampMin = "1"))
+	int32 MaxPrefetchChunks = 32;
+
+	/// Resident terrain memory (heights, mesh buffers, collision) the chunk manager stays under, 0 disables the budget.
+	/// Distant LOD rings start nearer when the render window would not fit, chunks are evicted or held back before going over
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", Units = "MB"))
+	int32 MemoryBudgetMB = 0;
+
+	/// Stores generated height grids in Saved/TerrainCache, revisited chunks are read back instead of generated again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseDiskCache = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bUseDiskCache"))
+	bool bCompressDiskCache = true;
+
+	/// Chunks around the spawn baked by the PTGSnapshotBake commandlet, read at startup instead of generated.
+	/// Relative to the project directory, ignored when empty or baked with other parameters
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (FilePathFilter = "ptgs", RelativeToGameDir))
+	FFilePath StartupSnapshot;
+
+	/// Regenerates the render window nearest first as soon as the noise parameters or layers change.
+	/// Displayed chunks keep their mesh until their replacement is ready, when disabled only new chunks use the new parameters
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bRebuildOnParameterChange = true;
+
+	/// Chunks found in the disk cache are still read back by the workers, heights generated on the GPU are saved to it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EChunkGenerationBackend GenerationBackend = EChunkGenerationBackend::CPU;
+
+	/// Chunks of the same LOD evaluated by a single compute dispatch
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "GenerationBackend == EChunkGenerationBackend::GPU", ClampMin = "1"))
+	int32 MaxChunksPerGPUDispatch = 16;
+};
+
+/// Chunk generation request
+struct FChunkGenerationRequest
+{
+	int32 X;
+	int32 Y;
+	float Priority;
+	int32 LOD = 0;
+};
+
+/// Height grid of a generated chunk, immutable once published so it is shared instead of copied
+struct FChunkHeights
+{
+	//////// CONSTRUCTORS ////////
+	FChunkHeights(TArray<float>&& _values, float _minHeight, float _maxHeight)
+		: Values(MoveTemp(_values)), MinHeight(_minHeight), MaxHeight(_maxHeight)
+	{
+	}
+
+	//////// FIELDS ////////
+	/// Vertex heights in world units, row-major (x + y * Resolution)
+	TArray<float> Values;
+	float MinHeight = 0.0f;
+	float MaxHeight = 0.0f;
+};
+
+typedef TSharedPtr<const FChunkHeights, ESPMode::ThreadSafe> FChunkHeightsPtr;
+
+/// Index and UV layout shared by every chunk with the same size, LOD and skirts
+struct FChunkTopology
+{
+	/// Vertices per chunk side
+	int32 Resolution = 0;
+
+	/// Skirt vertices follow the grid, Resolution per edge in EChunkBorder order
+	bool bSkirts = false;
+
+	TArray<int32> Triangles;
+	TArray<FVector2D> UVs;
+};
+
+typedef TSharedPtr<const FChunkTopology, ESPMode::ThreadSafe> FChunkTopologyPtr;
+
+/// Render buffers of a chunk, built by the workers and uploaded as is by the game thread
+struct FChunkMeshData
+{
+	TArray<FVector> Vertices;
+	TArray<FVector> Normals;
+
+	/// Shared with every chunk of the same layout, never copied per chunk
+	FChunkTopologyPtr Topology;
+};
+
+typedef TSharedPtr<const FChunkMeshData, ESPMode::ThreadSafe> FChunkMeshDataPtr;
+
+/// Bytes held by the data of a chunk, GPU copies and cooked collision are estimated from the buffer sizes
+struct FChunkMemoryUsage
+{
+	/// Height grid
+	uint64 HeightBytes = 0;
+
+	/// Render section buffers of the mesh component and their GPU copy
+	uint64 MeshBytes = 0;
+
+	/// Hidden collision section and its cooked body
+	uint64 CollisionBytes = 0;
+
+	FORCEINLINE uint64 GetTotal() const { return HeightBytes + MeshBytes + CollisionBytes; }
+
+	FChunkMemoryUsage& operator+=(const FChunkMemoryUsage& Other)
+	{
+		HeightBytes += Other.HeightBytes;
+		MeshBytes += Other.MeshBytes;
+		CollisionBytes += Other.CollisionBytes;
+		return *this;
+	}
+
+	FChunkMemoryUsage& operator-=(const FChunkMemoryUsage& Other)
+	{
+		HeightBytes -= FMath::Min(HeightBytes, Other.HeightBytes);
+		MeshBytes -= FMath::Min(MeshBytes, Other.MeshBytes);
+		CollisionBytes -= FMath::Min(CollisionBytes, Other.CollisionBytes);
+		return *this;
+	}
 };
 
-/// Chunk structure
+/// Chunk structure, vertex positions and normals are derived from the height grid
 USTRUCT()
 struct FChunk
 {
 	GENERATED_BODY()
 
+	/// Shared with the worker that generated it, copying a chunk never copies its heights. Null until generated
+	FChunkHeightsPtr HeightData;
+
+	/// Size of chunk footprint in full resolution samples
 	UPROPERTY()
-	TArray<FVertices> VertexArray;
+	int32 Size = 0;
 
+	/// Level of detail, samples are taken every 2^LOD full resolution samples
 	UPROPERTY()
-	int32 Size;
+	int32 LOD = 0;
 
 	UPROPERTY()
 	FVector Coords;
 
 	UPROPERTY()
 	int64 Id;
+
+	/// Generation inputs the heights come from, see ChunkData::GetParametersHash
+	UPROPERTY()
+	uint32 ParametersHash = 0;
+
+	//////// METHODS ////////
+	/// Height grid
+	FORCEINLINE bool IsGenerated() const { return HeightData.IsValid() && Size > 0 && HeightData->Values.Num() == GetResolution() * GetResolution(); }
+	FORCEINLINE const TArray<float>& GetHeights() const { return HeightData->Values; }
+	FORCEINLINE float GetHeight(int32 X, int32 Y) const { return HeightData->Values[X + Y * GetResolution()]; }
+	FORCEINLINE float GetMinHeight() const { return HeightData->MinHeight; }
+	FORCEINLINE float GetMaxHeight() const { return HeightData->MaxHeight; }
+
+	/// Sampling
+	FORCEINLINE int32 GetSampleStep() const { return 1 << LOD; }
+	FORCEINLINE int32 GetResolution() const { return GetLODResolution(Size, LOD); }
+	FORCEINLINE int32 GetSampleOffset(int32 Index) const { return FMath::Min(Index * GetSampleStep(), Size - 1); }
+	FORCEINLINE bool IsRegularGrid() const { return (Size - 1) % GetSampleStep() == 0; }
+
+	/// Position in chunk space, chunk origins are multiples of Size - 1
+	FORCEINLINE FIntPoint GetCell() const { return FIntPoint(FMath::RoundToInt(Coords.X) / (Size - 1), FMath::RoundToInt(Coords.Y) / (Size - 1)); }
+
+	/**
+	 * @brief Number of vertices per side of a chunk at a level of detail
+	 * @param _size Size of chunk in full resolution samples
+	 * @param _lod Level of detail
+	 * @return Vertices per side, the last one is clamped to the chunk edge when 2^LOD does not divide Size - 1
+	 */
+	static FORCEINLINE int32 GetLODResolution(int32 _size, int32 _lod)
+	{
+		return FMath::DivideAndRoundUp(_size - 1, 1 << _lod) + 1;
+	}
+
+	/**
+	 * @brief Computes the world position of a vertex
+	 * @param X Column of the vertex in the height grid
+	 * @param Y Row of the vertex in the height grid
+	 * @return Vertex position, full resolution samples are spaced 100 units apart
+	 */
+	FORCEINLINE FVector GetVertexPosition(int32 X, int32 Y) const
+	{
+		return FVector((Coords.X + GetSampleOffset(X)) * 100.0, (Coords.Y + GetSampleOffset(Y)) * 100.0, GetHeight(X, Y));
+	}
+
+	/**
+	 * @brief Bilinearly interpolates the height grid
+	 * @param X Distance to the chunk origin along X in full resolution samples, clamped to the chunk
+	 * @param Y Distance to the chunk origin along Y in full resolution samples, clamped to the chunk
+	 * @param OutGradient Height derivative along X and Y per full resolution sample, optional
+	 * @return Interpolated height in world units
+	 * @details Cells of the clamped last row and column are narrower, their interpolation uses their actual width
+	 */
+	float SampleHeight(float X, float Y, FVector2f* OutGradient = nullptr) const
+	{
+		auto FindCell = [this](float Position, int32& OutIndex, float& OutAlpha, float& OutWidth)
+		{
+			OutIndex = FMath::Clamp(FMath::FloorToInt(Position / GetSampleStep()), 0, GetResolution() - 2);
+			const int32 CellStart = GetSampleOffset(OutIndex);
+			OutWidth = GetSampleOffset(OutIndex + 1) - CellStart;
+			OutAlpha = FMath::Clamp((Position - CellStart) / OutWidth, 0.0f, 1.0f);
+		};
+
+		int32 CellX, CellY;
+		float AlphaX, AlphaY, WidthX, WidthY;
+		FindCell(X, CellX, AlphaX, WidthX);
+		FindCell(Y, CellY, AlphaY, WidthY);
+
+		const float H00 = GetHeight(CellX, CellY);
+		const float H10 = GetHeight(CellX + 1, CellY);
+		const float H01 = GetHeight(CellX, CellY + 1);
+		const float H11 = GetHeight(CellX + 1, CellY + 1);
+
+		if (OutGradient)
+		{
+			OutGradient->X = FMath::Lerp(H10 - H00, H11 - H01, AlphaY) / WidthX;
+			OutGradient->Y = FMath::Lerp(H01 - H00, H11 - H10, AlphaX) / WidthY;
+		}
+
+		return FMath::Lerp(FMath::Lerp(H00, H10, AlphaX), FMath::Lerp(H01, H11, AlphaX), AlphaY);
+	}
 };
 
 //////// NAMESPACE ////////
@@ -75,4 +529,75 @@ namespace ChunkData
 	{
 		return (2 * RenderDistance + 1) * (2 * RenderDistance + 1);
 	}
+
+	/**
+	 * @brief Computes the level of detail of the chunks of a ring around the player chunk
+	 * @param Ring Chebyshev distance to the player chunk, in chunks
+	 * @param Size Size of chunk in full resolution samples
+	 * @param Settings Streaming settings holding the LOD rings
+	 * @param RingWidth Width of the LOD rings, 0 uses Settings.LODRingWidth
+	 * @return One LOD per ring width, up to MaxLOD, 0 when LOD is disabled
+	 * @details The LOD is also limited so the sample step never exceeds the chunk side
+	 */
+	FORCEINLINE int32 GetRingLOD(int32 Ring, int32 Size, const FChunkStreamingSettings& Settings, int32 RingWidth = 0)
+	{
+		if (!Settings.bEnableLOD)
+		{
+			return 0;
+		}
+
+		int32 LOD = FMath::Min(Ring / FMath::Max(RingWidth > 0 ? RingWidth : Settings.LODRingWidth, 1), Settings.MaxLOD);
+		while (LOD > 0 && (1 << LOD) > Size - 1)
+		{
+			LOD--;
+		}
+		return LOD;
+	}
+
+	/// Parameters
+	/**
+	 * @brief Hashes everything the heights of a chunk depend on besides its position and LOD
+	 * @param Parameters Perlin noise parameters
+	 * @param Size Size of chunk in full resolution samples
+	 * @return Hash, equal for parameter sets generating the same terrain
+	 */
+	FORCEINLINE uint32 GetParametersHash(const FPerlinParameters& Parameters, int32 Size)
+	{
+		uint32 Hash = GetTypeHash(Parameters.Octaves);
+		Hash = HashCombine(Hash, GetTypeHash(Parameters.Frequency));
+		Hash = HashCombine(Hash, GetTypeHash(Parameters.Persistence));
+		Hash = HashCombine(Hash, GetTypeHash(Parameters.Seed));
+		Hash = HashCombine(Hash, GetTypeHash(Parameters.HeightFactor));
+		Hash = HashCombine(Hash, GetTypeHash((uint8)Parameters.Version));
+		return HashCombine(Hash, GetTypeHash(Size));
+	}
+
+	/**
+	 * @brief Hashes every input of the chunk heights besides the chunk position and LOD
+	 * @param Parameters Terrain noise parameters
+	 * @param BiomeParameters Biome noise parameters
+	 * @param Layers Layer graph applied on the noises
+	 * @param Size Size of chunk in full resolution samples
+	 * @return Hash, equal for setups generating the same terrain
+	 */
+	FORCEINLINE uint32 GetParametersHash(const FPerlinParameters& Parameters, const FPerlinParameters& BiomeParameters, const FTerrainLayerSettings& Layers, int32 Size)
+	{
+		uint32 Hash = GetParametersHash(Parameters, Size);
+		Hash = HashCombine(Hash, GetParametersHash(BiomeParameters, Size));
+		Hash = HashCombine(Hash, GetTypeHash(Layers.HeightScale));
+		Hash = HashCombine(Hash, GetTypeHash(Layers.GradientPower));
+		Hash = HashCombine(Hash, GetTypeHash(Layers.GradientSmoothing));
+		Hash = HashCombine(Hash, GetTypeHash(Layers.BiomeMaskRange));
+		for (const FTerrainNoiseLayer& Layer : Layers.Layers)
+		{
+			Hash = HashCombine(Hash, GetTypeHash((uint8)Layer.Source));
+			Hash = HashCombine(Hash, GetParametersHash(Layer.Noise, Size));
+			Hash = HashCombine(Hash, GetTypeHash((uint8)Layer.Shape));
+			Hash = HashCombine(Hash, GetTypeHash((uint8)Layer.Blend));
+			Hash = HashCombine(Hash, GetTypeHash(Layer.Amplitude));
+			Hash = HashCombine(Hash, GetTypeHash(Layer.MaskInfluence));
+			Hash = HashCombine(Hash, GetTypeHash(Layer.bInvertMask));
+		}
+		return Hash;
+	}
 }
@@ -0,0 +1,189 @@
+#include "PTG/Generation/Terrain/ChunkDiskCache.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/**
+ * @file ChunkDiskCache.cpp
+ * @brief Implementation of the on-disk chunk height cache
+ * @details One file per chunk and LOD, a fixed header followed by the raw or LZ4 compressed heights.
+ *          Files are written in native byte order, they are a local cache and never shipped
+ */
+
+//////// FILE FORMAT ////////
+/// Header of a cache entry
+struct FChunkCacheHeader
+{
+	uint32 Magic;
+	uint16 Version;
+	uint16 Flags;
+	uint32 ParametersHash;
+	int32 Size;
+	int32 LOD;
+	float MinHeight;
+	float MaxHeight;
+	int32 NumValues;
+	int32 PayloadSize;
+};
+
+static constexpr uint32 ChunkCacheMagic = 0x43475450; // "PTGC"
+static constexpr uint16 ChunkCacheCompressedFlag = 1 << 0;
+
+FChunkDiskCache::FChunkDiskCache(const FString& _directory, bool _bCompress)
+	: Directory(_directory), bCompress(_bCompress)
+{
+	IFileManager::Get().MakeDirectory(*Directory, true);
+}
+
+/**
+ * @brief Default cache location
+ * @return Saved/TerrainCache of the project
+ */
+FString FChunkDiskCache::GetDefaultDirectory()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TerrainCache"));
+}
+
+/**
+ * @brief Path of the entry of a chunk
+ * @param Chunk Chunk whose id and LOD name the entry
+ * @param ParametersHash Hash of the generation parameters, each parameter set has its own directory
+ * @return Absolute entry path
+ */
+FString FChunkDiskCache::GetEntryPath(const FChunk& Chunk, uint32 ParametersHash) const
+{
+	return FPaths::Combine(Directory, FString::Printf(TEXT("%08x"), ParametersHash),
+		FString::Printf(TEXT("%d_%d_L%d.ptgc"), FMath::RoundToInt(Chunk.Coords.X), FMath::RoundToInt(Chunk.Coords.Y), Chunk.LOD));
+}
+
+/**
+ * @brief Checks whether a chunk has an entry, without reading it
+ * @param Chunk Chunk with its size, LOD and coordinates set
+ * @param ParametersHash Hash of the parameters and layers the chunk is generated with
+ * @return True if an entry file exists, it may still turn out outdated or corrupted when loaded
+ */
+bool FChunkDiskCache::Contains(const FChunk& Chunk, uint32 ParametersHash) const
+{
+	return IFileManager::Get().FileExists(*GetEntryPath(Chunk, ParametersHash));
+}
+
+/**
+ * @brief Fills a chunk with cached heights
+ * @param Chunk Chunk with its size, LOD and coordinates set, receives the height grid on a hit
+ * @param ParametersHash Hash of the parameters and layers the chunk is generated with, see ChunkData::GetParametersHash
+ * @return True on a hit, missing, outdated and corrupted entries are misses
+ * @details Called by the workers, the read never blocks the game thread
+ */
+bool FChunkDiskCache::Load(FChunk& Chunk, uint32 ParametersHash)
+{
+	const int32 NumValues = Chunk.GetResolution() * Chunk.GetResolution();
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetEntryPath(Chunk, ParametersHash), FILEREAD_Silent) || Data.Num() < sizeof(FChunkCacheHeader))
+	{
+		Misses++;
+		return false;
+	}
+
+	FChunkCacheHeader Header;
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(FChunkCacheHeader));
+	const uint8* Payload = Data.GetData() + sizeof(FChunkCacheHeader);
+
+	if (Header.Magic != ChunkCacheMagic || Header.Version != FormatVersion || Header.ParametersHash != ParametersHash
+		|| Header.Size != Chunk.Size || Header.LOD != Chunk.LOD || Header.NumValues != NumValues
+		|| Header.PayloadSize != Data.Num() - (int32)sizeof(FChunkCacheHeader))
+	{
+		Misses++;
+		return false;
+	}
+
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(NumValues);
+	const int32 RawSize = NumValues * sizeof(float);
+
+	if (Header.Flags & ChunkCacheCompressedFlag)
+	{
+		if (!FCompression::UncompressMemory(NAME_LZ4, Heights.GetData(), RawSize, Payload, Header.PayloadSize))
+		{
+			Misses++;
+			return false;
+		}
+	}
+	else
+	{
+		if (Header.PayloadSize != RawSize)
+		{
+			Misses++;
+			return false;
+		}
+		FMemory::Memcpy(Heights.GetData(), Payload, RawSize);
+	}
+
+	Chunk.HeightData = MakeShared<FChunkHeights, ESPMode::ThreadSafe>(MoveTemp(Heights), Header.MinHeight, Header.MaxHeight);
+	Hits++;
+	return true;
+}
+
+/**
+ * @brief Writes the height grid of a generated chunk
+ * @param Chunk Generated chunk
+ * @param ParametersHash Hash of the parameters and layers the chunk was generated with
+ * @return True if the entry was written
+ * @details The entry is written to a temporary file then moved in place, so readers never see a partial file
+ */
+bool FChunkDiskCache::Save(const FChunk& Chunk, uint32 ParametersHash)
+{
+	if (!Chunk.IsGenerated())
+	{
+		return false;
+	}
+
+	const TArray<float>& Heights = Chunk.GetHeights();
+	const int32 RawSize = Heights.Num() * sizeof(float);
+
+	FChunkCacheHeader Header;
+	Header.Magic = ChunkCacheMagic;
+	Header.Version = FormatVersion;
+	Header.Flags = 0;
+	Header.ParametersHash = ParametersHash;
+	Header.Size = Chunk.Size;
+	Header.LOD = Chunk.LOD;
+	Header.MinHeight = Chunk.GetMinHeight();
+	Header.MaxHeight = Chunk.GetMaxHeight();
+	Header.NumValues = Heights.Num();
+	Header.PayloadSize = RawSize;
+
+	TArray<uint8> Data;
+	int32 PayloadSize = RawSize;
+
+	if (bCompress)
+	{
+		PayloadSize = FCompression::CompressMemoryBound(NAME_LZ4, RawSize);
+		Data.SetNumUninitialized(sizeof(FChunkCacheHeader) + PayloadSize);
+		if (FCompression::CompressMemory(NAME_LZ4, Data.GetData() + sizeof(FChunkCacheHeader), PayloadSize, Heights.GetData(), RawSize))
+		{
+			Header.Flags |= ChunkCacheCompressedFlag;
+			Header.PayloadSize = PayloadSize;
+		}
+		else
+		{
+			PayloadSize = RawSize;
+		}
+	}
+
+	Data.SetNumUninitialized(sizeof(FChunkCacheHeader) + PayloadSize, EAllowShrinking::No);
+	if (!(Header.Flags & ChunkCacheCompressedFlag))
+	{
+		FMemory::Memcpy(Data.GetData() + sizeof(FChunkCacheHeader), Heights.GetData(), RawSize);
+	}
+	FMemory::Memcpy(Data.GetData(), &Header, sizeof(FChunkCacheHeader));
+
+	const FString Path = GetEntryPath(Chunk, Header.ParametersHash);
+	const FString TempPath = Path + FString::Printf(TEXT(".%u.tmp"), FPlatformTLS::GetCurrentThreadId());
+	if (!FFileHelper::SaveArrayToFile(Data, *TempPath))
+	{
+		return false;
+	}
+	return IFileManager::Get().Move(*Path, *TempPath, true, true, false, true);
+}
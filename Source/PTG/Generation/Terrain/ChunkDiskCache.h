@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTG/Generation/Terrain/ChunkData.h"
+#include <atomic>
+
+//////// CLASS ////////
+/// On-disk cache of generated height grids, shared by the generation workers
+class FChunkDiskCache
+{
+public:
+	//////// CONSTRUCTORS ////////
+	/**
+	 * @brief Creates a cache rooted in a directory
+	 * @param _directory Directory holding one sub directory per parameter set
+	 * @param _bCompress Whether new entries are LZ4 compressed, entries of both kinds are always readable
+	 */
+	FChunkDiskCache(const FString& _directory, bool _bCompress);
+
+	//////// METHODS ////////
+	/// Entries, thread safe
+	bool Load(FChunk& Chunk, uint32 ParametersHash);
+	bool Save(const FChunk& Chunk, uint32 ParametersHash);
+	bool Contains(const FChunk& Chunk, uint32 ParametersHash) const;
+
+	/// Getters
+	const FString& GetDirectory() const { return Directory; }
+	int32 GetHitCount() const { return Hits; }
+	int32 GetMissCount() const { return Misses; }
+
+	/// Helpers
+	static FString GetDefaultDirectory();
+
+	/// Bumped whenever the file layout or the generated heights change, older entries are ignored
+	static constexpr uint16 FormatVersion = 1;
+
+private:
+	//////// FIELDS ////////
+	FString Directory;
+	bool bCompress = true;
+
+	/// Stats
+	std::atomic<int32> Hits = 0;
+	std::atomic<int32> Misses = 0;
+
+	//////// METHODS ////////
+	FString GetEntryPath(const FChunk& Chunk, uint32 ParametersHash) const;
+};
+
+typedef TSharedPtr<FChunkDiskCache, ESPMode::ThreadSafe> FChunkDiskCachePtr;
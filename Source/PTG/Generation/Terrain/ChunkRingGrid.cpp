@@ -0,0 +1,122 @@
+#include "PTG/Generation/Terrain/ChunkRingGrid.h"
+
+/**
+ * @file ChunkRingGrid.cpp
+ * @brief Implementation of the toroidal chunk index of the render window
+ * @details Moving the window only visits the rows and columns that leave and enter it
+ */
+
+/**
+ * @brief Empties the grid and places the window
+ * @param _radius Render distance in chunks
+ * @param _center Window center in chunk space
+ */
+void FChunkRingGrid::Reset(int32 _radius, const FIntPoint& _center)
+{
+	Radius = FMath::Max(_radius, 0);
+	Dimension = 2 * Radius + 1;
+	Center = _center;
+	Cells.Init(INDEX_NONE, Dimension * Dimension);
+}
+
+/**
+ * @brief Moves the window to a new center
+ * @param _center New window center in chunk space
+ * @param OutExitedChunks Tracked chunks of the cells that left the window
+ * @param OutEnteredCells Cells that entered the window, empty
+ * @return False if the window moved further than its radius, nothing is done and the caller resets it
+ * @details Costs O(Radius) per chunk of movement instead of O(Radius^2)
+ */
+bool FChunkRingGrid::Move(const FIntPoint& _center, TArray<int64>& OutExitedChunks, TArray<FIntPoint>& OutEnteredCells)
+{
+	const FIntPoint Delta = _center - Center;
+	if (!IsValid() || FMath::Abs(Delta.X) > Radius || FMath::Abs(Delta.Y) > Radius)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < FMath::Abs(Delta.X); i++)
+	{
+		MoveAxis(0, FMath::Sign(Delta.X), OutExitedChunks, OutEnteredCells);
+	}
+	for (int32 i = 0; i < FMath::Abs(Delta.Y); i++)
+	{
+		MoveAxis(1, FMath::Sign(Delta.Y), OutExitedChunks, OutEnteredCells);
+	}
+
+	// Cells entered by a step on one axis may have left again on the other one
+	OutEnteredCells.RemoveAllSwap([this](const FIntPoint& Cell) { return !Contains(Cell); }, EAllowShrinking::No);
+	return true;
+}
+
+/**
+ * @brief Lists the cells a window would enter by moving, without moving any grid
+ * @param _radius Window radius in chunks
+ * @param _from Previous window center in chunk space
+ * @param _to New window center in chunk space
+ * @param OutEnteredCells Cells of the window around _to outside the window around _from, appended
+ * @details Only visits the rows and columns past the previous window, O(Radius) per chunk of movement
+ */
+void FChunkRingGrid::GetEnteredCells(int32 _radius, const FIntPoint& _from, const FIntPoint& _to, TArray<FIntPoint>& OutEnteredCells)
+{
+	for (int32 y = _to.Y - _radius; y <= _to.Y + _radius; y++)
+	{
+		int32 MinX = _to.X - _radius;
+		int32 MaxX = _to.X + _radius;
+
+		// Rows shared with the previous window only enter the columns past it on the side of the move
+		if (FMath::Abs(y - _from.Y) <= _radius)
+		{
+			if (_to.X > _from.X)
+			{
+				MinX = FMath::Max(MinX, _from.X + _radius + 1);
+			}
+			else if (_to.X < _from.X)
+			{
+				MaxX = FMath::Min(MaxX, _from.X - _radius - 1);
+			}
+			else
+			{
+				continue;
+			}
+		}
+
+		for (int32 x = MinX; x <= MaxX; x++)
+		{
+			OutEnteredCells.Add(FIntPoint(x, y));
+		}
+	}
+}
+
+/**
+ * @brief Moves the window by one chunk along an axis
+ * @param Axis 0 for X, 1 for Y
+ * @param Direction 1 or -1
+ * @param OutExitedChunks Tracked chunks of the line that left the window
+ * @param OutEnteredCells Cells of the line that entered the window
+ * @details The leaving and entering lines are 2 * Radius + 1 apart, so they map to the same slots
+ */
+void FChunkRingGrid::MoveAxis(int32 Axis, int32 Direction, TArray<int64>& OutExitedChunks, TArray<FIntPoint>& OutEnteredCells)
+{
+	const int32 OtherAxis = 1 - Axis;
+	FIntPoint Exited = Center;
+	Exited[Axis] -= Direction * Radius;
+
+	for (int32 i = -Radius; i <= Radius; i++)
+	{
+		Exited[OtherAxis] = Center[OtherAxis] + i;
+
+		int64& Cell = Cells[GetSlot(Exited)];
+		if (Cell != INDEX_NONE)
+		{
+			OutExitedChunks.Add(Cell);
+			Cell = INDEX_NONE;
+		}
+
+		FIntPoint Entered = Exited;
+		Entered[Axis] += Direction * Dimension;
+		OutEnteredCells.Add(Entered);
+	}
+
+	Center[Axis] += Direction;
+}
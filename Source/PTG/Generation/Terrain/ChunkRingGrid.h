@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//////// CLASS ////////
+/// Toroidal index of the chunks inside the render window, addressed by chunk coordinates
+class FChunkRingGrid
+{
+public:
+	//////// METHODS ////////
+	/// Window management
+	void Reset(int32 _radius, const FIntPoint& _center);
+	bool Move(const FIntPoint& _center, TArray<int64>& OutExitedChunks, TArray<FIntPoint>& OutEnteredCells);
+	static void GetEnteredCells(int32 _radius, const FIntPoint& _from, const FIntPoint& _to, TArray<FIntPoint>& OutEnteredCells);
+
+	/// Cells
+	/**
+	 * @brief Checks whether a cell lies inside the window
+	 * @param Coords Cell in chunk space
+	 * @return True if the Chebyshev distance to the window center is at most the radius
+	 */
+	FORCEINLINE bool Contains(const FIntPoint& Coords) const
+	{
+		return Cells.Num() > 0 && FMath::Abs(Coords.X - Center.X) <= Radius && FMath::Abs(Coords.Y - Center.Y) <= Radius;
+	}
+
+	/// Tracked chunk of a cell inside the window, INDEX_NONE when empty
+	FORCEINLINE int64 GetChunk(const FIntPoint& Coords) const { return Cells[GetSlot(Coords)]; }
+	FORCEINLINE void SetChunk(const FIntPoint& Coords, int64 ChunkId) { Cells[GetSlot(Coords)] = ChunkId; }
+
+	/// Getters
+	FORCEINLINE int32 GetRadius() const { return Radius; }
+	FORCEINLINE const FIntPoint& GetCenter() const { return Center; }
+	FORCEINLINE bool IsValid() const { return Cells.Num() > 0; }
+
+private:
+	//////// FIELDS ////////
+	/// Cells of the (2 * Radius + 1)^2 window, a cell leaving on one side shares its slot with the cell entering on the other
+	TArray<int64> Cells;
+	FIntPoint Center = FIntPoint::ZeroValue;
+	int32 Radius = 0;
+	int32 Dimension = 0;
+
+	//////// METHODS ////////
+	void MoveAxis(int32 Axis, int32 Direction, TArray<int64>& OutExitedChunks, TArray<FIntPoint>& OutEnteredCells);
+
+	FORCEINLINE int32 Wrap(int32 Value) const
+	{
+		const int32 Slot = Value % Dimension;
+		return Slot < 0 ? Slot + Dimension : Slot;
+	}
+
+	FORCEINLINE int32 GetSlot(const FIntPoint& Coords) const
+	{
+		checkSlow(Contains(Coords));
+		return Wrap(Coords.X) + Wrap(Coords.Y) * Dimension;
+	}
+};
@@ -0,0 +1,209 @@
+#include "PTG/Generation/Terrain/ChunkScheduler.h"
+#include "PTG/PTG.h"
+
+/**
+ * @file ChunkScheduler.cpp
+ * @brief Implementation of the chunk generation worker pool
+ * @details Replaces one OS thread per chunk with a fixed set of workers sharing a priority queue
+ */
+
+FChunkScheduler::FChunkScheduler(int32 _numWorkers, EThreadPriority _priority)
+{
+	WorkAvailableEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+	const int32 NumWorkers = FMath::Max(1, _numWorkers);
+	Workers.Reserve(NumWorkers);
+	for (int32 i = 0; i < NumWorkers; i++)
+	{
+		Workers.Add(new FChunkThread(*this, i, _priority));
+	}
+
+	UE_LOG(LogPTG, Log, TEXT("Chunk scheduler started with %d workers"), NumWorkers);
+}
+
+/**
+ * @brief Drops queued jobs and joins every worker
+ */
+FChunkScheduler::~FChunkScheduler()
+{
+	CancelAll();
+	bShutdown = true;
+
+	for (FChunkThread* Worker : Workers)
+	{
+		Worker->Stop();
+	}
+	WorkAvailableEvent->Trigger();
+
+	for (FChunkThread* Worker : Workers)
+	{
+		delete Worker;
+	}
+	Workers.Empty();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkAvailableEvent);
+	WorkAvailableEvent = nullptr;
+}
+
+/**
+ * @brief Adds a job to the queue and wakes a worker
+ * @param Job Job to process, ordered by its Priority field
+ */
+void FChunkScheduler::Enqueue(const FChunkJobRef& Job)
+{
+	{
+		FScopeLock Lock(&QueueLock);
+		JobHeap.HeapPush(Job, &FChunkScheduler::JobPredicate);
+	}
+	WorkAvailableEvent->Trigger();
+}
+
+/**
+ * @brief Adds several jobs to the queue under a single lock
+ * @param Jobs Jobs to process
+ * @details Wakes the workers once, the wake-up is then chained between them
+ */
+void FChunkScheduler::EnqueueBatch(TConstArrayView<FChunkJobRef> Jobs)
+{
+	if (Jobs.Num() == 0)
+	{
+		return;
+	}
+
+	{
+		FScopeLock Lock(&QueueLock);
+		for (const FChunkJobRef& Job : Jobs)
+		{
+			JobHeap.HeapPush(Job, &FChunkScheduler::JobPredicate);
+		}
+	}
+	WorkAvailableEvent->Trigger();
+}
+
+/**
+ * @brief Cancels a job
+ * @param Job Job to cancel
+ * @return True if the job was still queued and has been removed,
+ *         false if it is already running (it will then be discarded on completion)
+ */
+bool FChunkScheduler::Cancel(const FChunkJobRef& Job)
+{
+	Job->Cancel();
+
+	FScopeLock Lock(&QueueLock);
+	const int32 Index = JobHeap.IndexOfByKey(Job);
+	if (Index != INDEX_NONE)
+	{
+		JobHeap.HeapRemoveAt(Index, &FChunkScheduler::JobPredicate);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Cancels and drops every queued job
+ */
+void FChunkScheduler::CancelAll()
+{
+	FScopeLock Lock(&QueueLock);
+	for (const FChunkJobPtr& Job : JobHeap)
+	{
+		Job->Cancel();
+	}
+	JobHeap.Empty();
+}
+
+/**
+ * @brief Changes the priority of every worker thread
+ * @param _priority New OS thread priority
+ */
+void FChunkScheduler::SetThreadPriority(EThreadPriority _priority)
+{
+	for (FChunkThread* Worker : Workers)
+	{
+		if (Worker->Thread)
+		{
+			Worker->Thread->SetThreadPriority(_priority);
+		}
+	}
+}
+
+/**
+ * @brief Blocks the calling worker until a job is available
+ * @return Highest priority job, or null on timeout or shutdown
+ * @details Wakes the next worker when jobs remain so a burst of requests fans out over the whole pool
+ */
+FChunkJobPtr FChunkScheduler::WaitForJob()
+{
+	for (;;)
+	{
+		if (bShutdown)
+		{
+			WorkAvailableEvent->Trigger();
+			return nullptr;
+		}
+
+		{
+			FScopeLock Lock(&QueueLock);
+			if (JobHeap.Num() > 0)
+			{
+				FChunkJobPtr Job;
+				JobHeap.HeapPop(Job, &FChunkScheduler::JobPredicate, EAllowShrinking::No);
+				InFlightJobs++;
+
+				if (JobHeap.Num() > 0)
+				{
+					WorkAvailableEvent->Trigger();
+				}
+				return Job;
+			}
+		}
+
+		if (!WorkAvailableEvent->Wait(100))
+		{
+			return nullptr;
+		}
+	}
+}
+
+/**
+ * @brief Called by a worker once a job has been processed
+ * @param Job Processed job
+ * @details Queues the result for the game thread unless the job was cancelled meanwhile
+ */
+void FChunkScheduler::CompleteJob(const FChunkJobRef& Job)
+{
+	if (!Job->IsCancelled())
+	{
+		CompletedJobs.Enqueue(Job);
+	}
+
+	InFlightJobs--;
+}
+
+int32 FChunkScheduler::GetQueuedJobCount() const
+{
+	FScopeLock Lock(&QueueLock);
+	return JobHeap.Num();
+}
+
+/**
+ * @brief Converts the exposed worker priority to an OS thread priority
+ * @param Priority Worker priority from the streaming settings
+ * @return Matching thread priority
+ */
+EThreadPriority FChunkScheduler::ToThreadPriority(EChunkWorkerPriority Priority)
+{
+	switch (Priority)
+	{
+	case EChunkWorkerPriority::Lowest:
+		return TPri_Lowest;
+	case EChunkWorkerPriority::Normal:
+		return TPri_Normal;
+	case EChunkWorkerPriority::AboveNormal:
+		return TPri_AboveNormal;
+	case EChunkWorkerPriority::BelowNormal:
+	default:
+		return TPri_BelowNormal;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "PTG/Generation/Terrain/ChunkThread.h"
+#include <atomic>
+
+//////// CLASS ////////
+/// Fixed-size worker pool with a priority job queue for chunk generation
+class FChunkScheduler
+{
+public:
+	//////// CONSTRUCTORS ////////
+	/**
+	 * @brief Creates the pool and starts its workers
+	 * @param _numWorkers Number of worker threads, clamped to at least one
+	 * @param _priority Priority of the worker threads
+	 */
+	FChunkScheduler(int32 _numWorkers, EThreadPriority _priority);
+	~FChunkScheduler();
+
+	//////// METHODS ////////
+	/// Job management
+	void Enqueue(const FChunkJobRef& Job);
+	void EnqueueBatch(TConstArrayView<FChunkJobRef> Jobs);
+	bool Cancel(const FChunkJobRef& Job);
+	void CancelAll();
+
+	/// Workers
+	void SetThreadPriority(EThreadPriority _priority);
+
+	/// Worker interface
+	FChunkJobPtr WaitForJob();
+	void CompleteJob(const FChunkJobRef& Job);
+
+	/// Game thread interface
+	bool DequeueCompletedJob(FChunkJobPtr& OutJob) { return CompletedJobs.Dequeue(OutJob); }
+
+	/// Getters
+	int32 GetNumWorkers() const { return Workers.Num(); }
+	int32 GetQueuedJobCount() const;
+	int32 GetInFlightJobCount() const { return InFlightJobs; }
+
+	/// Helpers
+	static int32 GetDefaultWorkerCount() { return FMath::Max(1, FPlatformMisc::NumberOfWorkerThreadsToSpawn()); }
+	static EThreadPriority ToThreadPriority(EChunkWorkerPriority Priority);
+
+private:
+	//////// FIELDS ////////
+	/// Job queue, kept as a binary heap ordered by FChunkJob::Priority
+	TArray<FChunkJobPtr> JobHeap;
+	mutable FCriticalSection QueueLock;
+	FEvent* WorkAvailableEvent = nullptr;
+
+	/// Finished jobs, filled by the workers and drained by the game thread
+	TQueue<FChunkJobPtr, EQueueMode::Mpsc> CompletedJobs;
+
+	/// Workers
+	TArray<FChunkThread*> Workers;
+	std::atomic<int32> InFlightJobs = 0;
+	std::atomic<bool> bShutdown = false;
+
+	//////// METHODS ////////
+	/// Helpers
+	static bool JobPredicate(const FChunkJobPtr& A, const FChunkJobPtr& B) { return A->Priority < B->Priority; }
+};
@@ -1,90 +1,328 @@
 #include "PTG/Generation/Terrain/ChunkThread.h"
+#include "PTG/PTG.h"
+#include "PTG/Generation/Terrain/ChunkScheduler.h"
 #include "PTG/Generation/Utils/PerlinNoise.h"
+#include "PTG/Generation/Subsystems/ProceduralMeshGeneratorSubsystem.h"
 
 /**
  * @file ChunkThread.cpp
- * @brief Implementation of asynchronous chunk generation thread
- * @details Handles terrain calculation in a separate thread to avoid blocking the game thread
+ * @brief Implementation of the chunk generation worker threads
+ * @details Handles terrain calculation in pooled threads to avoid blocking the game thread
  */
 
+/**
+ * @brief Stops the worker and waits for the OS thread to finish
+ */
+FChunkThread::~FChunkThread()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
 bool FChunkThread::Init()
 {
-	UE_LOG(LogTemp, Warning, TEXT("Generating Chunk Init"));
+	UE_LOG(LogPTG, Verbose, TEXT("Chunk Worker Init"));
 	return true;
 }
 
 /**
- * @brief Main thread execution method for chunk generation
- * @return Thread completion status (1 for success)
- * @details Generates terrain vertices using Perlin noise in batches
- *          with sleep intervals to prevent thread hogging
+ * @brief Main worker loop
+ * @return Thread completion status (0 once the pool shuts down)
+ * @details Pulls the highest priority job from the scheduler, runs the noise then the mesh stage
+ *          and hands it back, until the scheduler is destroyed. Heights baked in the startup snapshot, found in the disk cache
+ *          or already computed on the GPU skip the noise stage, snapshot chunks come with their aprons and skip the apron stage too.
+ *          Heights computed by the noise stage or on the GPU are saved to the disk cache
  */
 uint32 FChunkThread::Run()
 {
-	UE_LOG(LogTemp, Warning, TEXT("Generating Chunk Run"));
-	int _size = Chunk.Size;
+	while (!bShutdown)
+	{
+		FChunkJobPtr Job = Scheduler.WaitForJob();
+		if (!Job.IsValid())
+		{
+			continue;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::Run);
+			SCOPE_CYCLE_COUNTER(STAT_PTG_WorkerJob);
+
+			bool bNewHeights = Job->bComputedOnGPU;
+			if (!Job->IsCancelled() && !Job->Chunk.IsGenerated()
+				&& !(Job->Snapshot.IsValid() && Job->Snapshot->FillChunk(Job->Chunk, Job->ApronHeights))
+				&& !(Job->DiskCache.IsValid() && Job->DiskCache->Load(Job->Chunk, Job->Chunk.ParametersHash)))
+			{
+				GenerateChunk(*Job);
+				bNewHeights = true;
+			}
+
+			if (bNewHeights && Job->DiskCache.IsValid() && !Job->IsCancelled() && Job->Chunk.IsGenerated())
+			{
+				Job->DiskCache->Save(Job->Chunk, Job->Chunk.ParametersHash);
+			}
+
+			if (!Job->IsCancelled() && Job->Chunk.IsGenerated())
+			{
+				GenerateApron(*Job);
+			}
+
+			if (!Job->IsCancelled() && Job->Chunk.IsGenerated())
+			{
+				BuildMesh(*Job);
+			}
+		}
+		Job->WorkerSeconds = FPlatformTime::Seconds() - StartTime;
+
+		Scheduler.CompleteJob(Job.ToSharedRef());
+	}
+
+	return 0;
+}
+
+/// Run of grid samples evenly spaced by the sample step
+struct FSampleSpan
+{
+	int32 First;
+	int32 Count;
+	int32 Offset;
+};
+
+/**
+ * @brief Splits a range of grid indices into runs the tile kernel can evaluate with a single step
+ * @param Chunk Chunk whose grid is sampled
+ * @param First First grid index of the range
+ * @param Last Grid index past the end of the range
+ * @param OutSpans Regular run, then the last sample when it is clamped to the chunk edge
+ * @return Number of spans written
+ */
+static int32 GetSampleSpans(const FChunk& Chunk, int32 First, int32 Last, FSampleSpan (&OutSpans)[2])
+{
+	const int32 Resolution = Chunk.GetResolution();
+	const int32 RegularCount = Chunk.IsRegularGrid() ? Resolution : Resolution - 1;
+	const int32 RegularLast = FMath::Min(Last, RegularCount);
+	int32 NumSpans = 0;
+
+	if (First < RegularLast)
+	{
+		OutSpans[NumSpans++] = { First, RegularLast - First, Chunk.GetSampleOffset(First) };
+	}
+	if (RegularCount < Resolution && Last == Resolution)
+	{
+		OutSpans[NumSpans++] = { Resolution - 1, 1, Chunk.Size - 1 };
+	}
+	return NumSpans;
+}
+
+/**
+ * @brief Generates the height grid of a job using Perlin noise
+ * @param Job Job holding the chunk to fill and its parameters
+ * @details Heights are evaluated by the layer graph RowsPerCheckpoint rows at a time,
+ *          a checkpoint between blocks aborts cancelled jobs and yields the time slice to other ready threads.
+ *          Edges shared with already generated neighbors are copied from Job.BorderHeights instead of being sampled again.
+ *          At LOD n samples are 2^n apart, the last row and column stay on the chunk edge so neighbors always line up
+ */
+void FChunkThread::GenerateChunk(FChunkJob& Job)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateChunk);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_GenerateChunk);
+
+	FChunk& Chunk = Job.Chunk;
+	int _resolution = Chunk.GetResolution();
+	int _step = Chunk.GetSampleStep();
 	int _x = Chunk.Coords.X;
 	int _y = Chunk.Coords.Y;
-	float min = 0.0f;
-	float max = 0.0f;
-	const int BatchSize = 100;
-	int processedVertices = 0;
-	const int32 totalVertices = _size * _size;
-	TArray<FVertices> TempVertices; // Cur Vertices
-	
-	TempVertices.Reserve(_size * _size);
-
-	for (int y= _y,y_scaled = _y*100; y < _y + _size; y++,y_scaled+=100)
+	TArray<float> Heights;
+
+	Heights.SetNumUninitialized(_resolution * _resolution);
+
+	auto HasBorder = [&Job, _resolution](EChunkBorder Border) { return Job.BorderHeights[(int32)Border].Num() == _resolution; };
+
+	// Only the samples not shared with a known neighbor are computed
+	const int32 FirstColumn = HasBorder(EChunkBorder::West) ? 1 : 0;
+	const int32 LastColumn = HasBorder(EChunkBorder::East) ? _resolution - 1 : _resolution;
+	const int32 FirstRow = HasBorder(EChunkBorder::South) ? 1 : 0;
+	const int32 LastRow = HasBorder(EChunkBorder::North) ? _resolution - 1 : _resolution;
+
+	FSampleSpan RowSpans[2];
+	FSampleSpan ColumnSpans[2];
+	const int32 NumRowSpans = GetSampleSpans(Chunk, FirstRow, LastRow, RowSpans);
+	const int32 NumColumnSpans = GetSampleSpans(Chunk, FirstColumn, LastColumn, ColumnSpans);
+
+	// Lattice gradients are shared by every block of the chunk and by the aprons, one extra lane group covers the padded lanes of each block
+	FTerrainLayerGraph& Graph = GetLayerGraph(Job);
+	const FVector2f LatticeOrigin(_x - _step, _y - _step);
+	Graph.BuildLattices(LatticeOrigin, FTerrainLayerGraph::GetTileMaxCoordinates(LatticeOrigin, _step, _resolution + 2 + UPerlinNoise::TileLaneCount, _resolution + 2));
+
+	// Noise is evaluated a block of rows at a time by the vectorized tile kernels
+	for (int32 RowSpan = 0; RowSpan < NumRowSpans; RowSpan++)
 	{
-		for (int x = _x,x_scaled = _x*100; x < _x + _size; x++,x_scaled+=100)
+		const FSampleSpan& Rows = RowSpans[RowSpan];
+		for (int Row = Rows.First; Row < Rows.First + Rows.Count; Row += RowsPerCheckpoint)
 		{
-			//float Z = UPerlinNoise::GenerateOctavePerlinValue(x, y, Parameters.Octaves, Parameters.Persistence, Parameters.Frequency, Parameters.Seed) * Parameters.HeightFactor; //Old noise
-			float Z =  100004.0 * UPerlinNoise::GenerateOctavePerlinSmoothed(x, y, Parameters.Octaves, Parameters.Persistence, Parameters.Frequency, Parameters.Seed, 3.0f, 0.9f, FVector2D(1.0f / 64.0f));
+			// The chunk left the render window, its result would be discarded
+			if (!YieldCheckpoint(Job))
+			{
+				return;
+			}
+
+			const int32 NumRows = FMath::Min(RowsPerCheckpoint, Rows.First + Rows.Count - Row);
+			const float Y = _y + Rows.Offset + (Row - Rows.First) * _step;
+
+			for (int32 ColumnSpan = 0; ColumnSpan < NumColumnSpans; ColumnSpan++)
+			{
+				const FSampleSpan& Columns = ColumnSpans[ColumnSpan];
+				Graph.EvaluateTile(Heights.GetData() + Row * _resolution + Columns.First, FVector2f(_x + Columns.Offset, Y), _step, Columns.Count, NumRows, _resolution);
+			}
+		}
+	}
+
+	// Shared edges, copied from the neighbor
+	for (int i = 0; i < _resolution; i++)
+	{
+		if (HasBorder(EChunkBorder::South)) { Heights[i] = Job.BorderHeights[(int32)EChunkBorder::South][i]; }
+		if (HasBorder(EChunkBorder::North)) { Heights[i + (_resolution - 1) * _resolution] = Job.BorderHeights[(int32)EChunkBorder::North][i]; }
+		if (HasBorder(EChunkBorder::West)) { Heights[i * _resolution] = Job.BorderHeights[(int32)EChunkBorder::West][i]; }
+		if (HasBorder(EChunkBorder::East)) { Heights[(_resolution - 1) + i * _resolution] = Job.BorderHeights[(int32)EChunkBorder::East][i]; }
+	}
+
+	float min = Heights[0];
+	float max = Heights[0];
+	for (float Height : Heights)
+	{
+		min = FMath::Min(min, Height);
+		max = FMath::Max(max, Height);
+	}
 
-			FVertices vertex;
-			vertex.Coords = FVector(x_scaled, y_scaled, Z);
+	// Single allocation, published as is and never copied afterwards
+	Chunk.HeightData = MakeShared<FChunkHeights, ESPMode::ThreadSafe>(MoveTemp(Heights), min, max);
+
+	UE_LOG(LogPTGChunk, VeryVerbose, TEXT("Chunk %lld generated, heights in [%f, %f]"), Chunk.Id, min, max);
+}
+
+/**
+ * @brief Samples the vertices just outside the chunk edges
+ * @param Job Job holding the generated chunk
+ * @details Aprons lie one sample step outside the edges. Those already copied from generated neighbors are kept,
+ *          the others are sampled with the same layer graph so both sides of an edge see identical heights and get matching normals.
+ *          The lattice caches of the noise stage already cover them, chunks read from the disk cache or the GPU build them per strip
+ */
+void FChunkThread::GenerateApron(FChunkJob& Job)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::GenerateApron);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_GenerateApron);
+
+	const FChunk& Chunk = Job.Chunk;
+	FTerrainLayerGraph& Graph = GetLayerGraph(Job);
+	const int32 _resolution = Chunk.GetResolution();
+	const int32 _step = Chunk.GetSampleStep();
+	const int32 _x = Chunk.Coords.X;
+	const int32 _y = Chunk.Coords.Y;
+
+	FSampleSpan Spans[2];
+	const int32 NumSpans = GetSampleSpans(Chunk, 0, _resolution, Spans);
+
+	struct FApronStrip
+	{
+		EChunkBorder Border;
+		bool bRow;
+		int32 Offset;
+	};
+	const FApronStrip Strips[] =
+	{
+		{ EChunkBorder::South, true, -_step },
+		{ EChunkBorder::North, true, Chunk.Size - 1 + _step },
+		{ EChunkBorder::West, false, -_step },
+		{ EChunkBorder::East, false, Chunk.Size - 1 + _step },
+	};
 
-			if (vertex.Coords.Z > max) { max = vertex.Coords.Z; }
-			else if (vertex.Coords.Z < min) { min = vertex.Coords.Z; }
-			vertex.Normal = FVector(0.0f, 0.0f, 1.0f);
+	for (const FApronStrip& Strip : Strips)
+	{
+		TArray<float>& Apron = Job.ApronHeights[(int32)Strip.Border];
+		if (Apron.Num() == _resolution)
+		{
+			continue;
+		}
 
-			TempVertices.Add(vertex);
-			processedVertices++;
-			
-			if (processedVertices % BatchSize == 0)
+		Apron.SetNumUninitialized(_resolution);
+		for (int32 Span = 0; Span < NumSpans; Span++)
+		{
+			// Rows of a column strip are one float apart
+			const FSampleSpan& Samples = Spans[Span];
+			const FVector2f Origin = Strip.bRow ? FVector2f(_x + Samples.Offset, _y + Strip.Offset) : FVector2f(_x + Strip.Offset, _y + Samples.Offset);
+			const int32 SizeX = Strip.bRow ? Samples.Count : 1;
+			const int32 SizeY = Strip.bRow ? 1 : Samples.Count;
+			const FVector2f Max = FTerrainLayerGraph::GetTileMaxCoordinates(Origin, _step, SizeX, SizeY);
+			if (!Graph.CoversRegion(Origin, Max))
 			{
-				FPlatformProcess::Sleep(0.001f);
+				Graph.BuildLattices(Origin, Max);
 			}
+			Graph.EvaluateTile(Apron.GetData() + Samples.First, Origin, _step, SizeX, SizeY, 1);
 		}
 	}
 
+	// Last stage reading the noise, the lattice caches are not kept until the job is integrated
+	Job.LayerGraph.Reset();
+}
+
+/**
+ * @brief Returns the compiled layer graph of a job, compiled on first use
+ * @param Job Job being generated
+ * @return Graph of the job parameters and layers
+ */
+FTerrainLayerGraph& FChunkThread::GetLayerGraph(FChunkJob& Job)
+{
+	if (!Job.LayerGraph.IsValid())
 	{
-		FScopeLock Lock(&ChunkLock);
-		Chunk.VertexArray.Append(TempVertices);
+		Job.LayerGraph = MakeUnique<FTerrainLayerGraph>(Job.Parameters, Job.BiomeParameters, Job.LayerSettings.IsValid() ? *Job.LayerSettings : FTerrainLayerSettings());
 	}
-	
-	UE_LOG(LogTemp, Error, TEXT("min : %f"),min);
-	UE_LOG(LogTemp, Error, TEXT("max : %f"),max);
-	return 1;
+	return *Job.LayerGraph;
 }
 
 /**
- * @brief Cleanup method called when thread completes
- * @details Broadcasts completion event and cleans up thread resources
+ * @brief Builds the render buffers of a generated chunk
+ * @param Job Job holding the generated chunk
+ * @details Second pipeline stage, leaves only the section upload to the game thread.
+ *          The topology is normally shared from the mesh subsystem cache at dispatch
  */
-void FChunkThread::Exit()
+void FChunkThread::BuildMesh(FChunkJob& Job)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkThread::BuildMesh);
+	SCOPE_CYCLE_COUNTER(STAT_PTG_BuildMesh);
+
+	const FChunkTopologyPtr Topology = Job.Topology.IsValid() ? Job.Topology : UProceduralMeshGeneratorSubsystem::BuildChunkTopology(Job.Chunk.Size, Job.Chunk.LOD, Job.SkirtDepth > 0.0f);
+
+	TSharedRef<FChunkMeshData, ESPMode::ThreadSafe> MeshData = MakeShared<FChunkMeshData, ESPMode::ThreadSafe>();
+	UProceduralMeshGeneratorSubsystem::BuildChunkMeshData(Job.Chunk, Topology, *MeshData, Job.ApronHeights, Job.SkirtDepth);
+	Job.MeshData = MeshData;
+}
+
+/**
+ * @brief Cooperative checkpoint between generation rows
+ * @param Job Job being generated
+ * @return False if the job has been cancelled and generation must stop
+ */
+bool FChunkThread::YieldCheckpoint(const FChunkJob& Job)
 {
-	UE_LOG(LogTemp, Warning, TEXT("Generating Chunk Exit"));
-	
-	AsyncTask(ENamedThreads::GameThread, [this]()
+	if (Job.IsCancelled())
 	{
-		bisOver = true;
-		OnCalcOver.Broadcast(Chunk.Id, Chunk);
+		return false;
+	}
 
-		delete Thread;
-		Thread = nullptr;
-		delete this;
-	});
+	FPlatformProcess::YieldThread();
+	return !Job.IsCancelled();
+}
+
+/**
+ * @brief Cleanup method called when the worker loop returns
+ */
+void FChunkThread::Exit()
+{
+	UE_LOG(LogPTG, Verbose, TEXT("Chunk Worker Exit"));
 }
 
 void FChunkThread::Stop()
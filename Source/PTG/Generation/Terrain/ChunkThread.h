@@ -1,45 +1,115 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
 #include "PTG/Generation/Terrain/ChunkData.h"
+#include "PTG/Generation/Terrain/ChunkDiskCache.h"
+#include "PTG/Generation/Terrain/TerrainLayerGraph.h"
+#include "PTG/Generation/Terrain/TerrainSnapshot.h"
+#include <atomic>
 
-//////// DELEGATES ////////
-DECLARE_MULTICAST_DELEGATE_TwoParams(FChunkDelegate, int64,FChunk);
+//////// FORWARD DECLARATION ////////
+/// Class
+class FChunkScheduler;
+
+//////// STRUCTS ////////
+/// Single chunk generation request processed by the worker pool
+struct FChunkJob
+{
+	//////// CONSTRUCTORS ////////
+	FChunkJob(const FChunk& _chunk, const FPerlinParameters& _parameters, const FPerlinParameters& _biomeParameters, float _priority)
+		: Chunk(_chunk), Parameters(_parameters), BiomeParameters(_biomeParameters), Priority(_priority)
+	{
+	}
+
+	//////// METHODS ////////
+	void Cancel() { bCancelled = true; }
+	bool IsCancelled() const { return bCancelled; }
+
+	//////// FIELDS ////////
+	/// Job data
+	FChunk Chunk;
+	FPerlinParameters Parameters;
+	FPerlinParameters BiomeParameters;
+	FTerrainLayerSettingsPtr LayerSettings;
+
+	/// Compiled layers of the noise stage, kept for the apron stage so both share the lattice caches
+	TUniquePtr<FTerrainLayerGraph> LayerGraph;
+
+	/// Shared index and UV layout the mesh stage builds on
+	FChunkTopologyPtr Topology;
+	float SkirtDepth = 0.0f;
+
+	/// Cache of previously generated heights, null when disabled
+	FChunkDiskCachePtr DiskCache;
+
+	/// Heights computed by a compute dispatch, only the worker saves them to the disk cache
+	bool bComputedOnGPU = false;
+
+	/// Baked startup terrain holding the chunk, null when the chunk is generated
+	FTerrainSnapshotPtr Snapshot;
+
+	/// Result of the mesh stage, ready to upload
+	FChunkMeshDataPtr MeshData;
+
+	/// Final heights of the edges shared with already generated neighbors, indexed by EChunkBorder, empty when unknown
+	TArray<float> BorderHeights[(int32)EChunkBorder::Count];
+
+	/// Final heights one vertex outside each edge, indexed by EChunkBorder, used for seamless normals
+	TArray<float> ApronHeights[(int32)EChunkBorder::Count];
+
+	/// Scheduling, lower values are processed first
+	float Priority = 0.0f;
+	std::atomic<bool> bCancelled = false;
+
+	/// Time the worker spent on the job, from dequeue to completion, in seconds
+	double WorkerSeconds = 0.0;
+};
+
+typedef TSharedRef<FChunkJob, ESPMode::ThreadSafe> FChunkJobRef;
+typedef TSharedPtr<FChunkJob, ESPMode::ThreadSafe> FChunkJobPtr;
 
 //////// CLASS ////////
-/// Thread handling async chunk generation
+/// Worker thread of the chunk scheduler pool, runs queued generation jobs until the pool shuts down
 class FChunkThread : public FRunnable
 {
 public:
 	//////// CONSTRUCTORS ////////
 	/**
-	 * @brief Constructor for chunk generation thread
-	 * @param _chunk Chunk data to generate
-	 * @param _parameters Terrain generation parameters
-	 * @param _biomeParameters Biome generation parameters
-	 * @details Creates and starts a new thread with below normal priority
+	 * @brief Constructor for chunk generation worker
+	 * @param _scheduler Scheduler owning the job queue
+	 * @param _index Index of the worker in the pool, used for the thread name
+	 * @param _priority Priority of the underlying OS thread
+	 * @details Creates and starts a new worker thread
 	 */
-	FChunkThread(FChunk _chunk,FPerlinParameters _parameters, FPerlinParameters _biomeParameters) : Chunk(_chunk), Parameters(_parameters), BiomeParameters(_biomeParameters)
+	FChunkThread(FChunkScheduler& _scheduler, int32 _index, EThreadPriority _priority) : Scheduler(_scheduler)
 	{
-		Thread = FRunnableThread::Create(this, TEXT("MyThread"), 0, TPri_BelowNormal);
+		Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("ChunkWorker%d"), _index), 0, _priority);
 	};
 
+	virtual ~FChunkThread() override;
+
 	//////// UNREAL LIFECYCLE ////////
 	virtual bool Init() override;
 	virtual uint32 Run() override;
 	virtual void Exit() override;
 	virtual void Stop() override;
 
+	//////// METHODS ////////
+	/// Generation stages
+	static void GenerateChunk(FChunkJob& Job);
+	static void GenerateApron(FChunkJob& Job);
+	static void BuildMesh(FChunkJob& Job);
+	static bool YieldCheckpoint(const FChunkJob& Job);
+	static FTerrainLayerGraph& GetLayerGraph(FChunkJob& Job);
+
+	/// Rows generated between two cancellation and yield checkpoints
+	static constexpr int32 RowsPerCheckpoint = 8;
+
 	//////// FIELDS ////////
 	/// Thread data
 	FRunnableThread* Thread;
-	FChunk Chunk;
-	FPerlinParameters Parameters;
-	FPerlinParameters BiomeParameters;
-	bool bShutdown = false;
-	bool bisOver = false;
-
-	/// Delegates
-	FChunkDelegate OnCalcOver;
-	FCriticalSection ChunkLock;
+	FChunkScheduler& Scheduler;
+	std::atomic<bool> bShutdown = false;
 };
@@ -0,0 +1,129 @@
+#include "PTG/Generation/Terrain/HeightmapExporter.h"
+#include "PTG/PTG.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+
+/**
+ * @file HeightmapExporter.cpp
+ * @brief Implementation of the tiled heightmap export
+ * @details Pixels are the samples of the chunk generator and go through the same tile kernels and layer blend, so an
+ *          R32F export holds the exact heights of the CPU generated chunks covering it. Files are written a row of
+ *          tiles at a time, memory use depends on the image width and not on its height
+ */
+
+FHeightmapExporter::FHeightmapExporter(const FHeightmapExportSettings& _settings, const FPerlinParameters& _terrainParameters, const FPerlinParameters& _biomeParameters, const FTerrainLayerSettings& _layers)
+	: Settings(_settings), Graph(_terrainParameters, _biomeParameters, _layers)
+{
+	Settings.Size = FIntPoint(FMath::Max(Settings.Size.X, 1), FMath::Max(Settings.Size.Y, 1));
+	Settings.SampleStep = FMath::Max(Settings.SampleStep, 1);
+	Settings.TileSize = FMath::Max(Settings.TileSize, 16);
+}
+
+/**
+ * @brief Streams the image to a raw file, rows from the first one, little endian pixels
+ * @param _path Output file, .r16 or .r32 by convention, see GetFileExtension
+ * @return False if the file could not be written
+ */
+bool FHeightmapExporter::ExportToFile(const FString& _path) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FHeightmapExporter::ExportToFile);
+
+	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*_path));
+	if (!File)
+	{
+		UE_LOG(LogPTG, Error, TEXT("Heightmap export: cannot open %s"), *_path);
+		return false;
+	}
+
+	const int64 RowBytes = GetRowBytes();
+	TArray64<uint8> Band;
+	Band.SetNumUninitialized(RowBytes * FMath::Min(Settings.TileSize, Settings.Size.Y));
+
+	for (int32 Row = 0; Row < Settings.Size.Y && !File->IsError(); Row += Settings.TileSize)
+	{
+		const int32 NumRows = FMath::Min(Settings.TileSize, Settings.Size.Y - Row);
+		ExportRows(Band.GetData(), Row, NumRows);
+		File->Serialize(Band.GetData(), RowBytes * NumRows);
+
+		UE_LOG(LogPTG, Display, TEXT("Heightmap export: %d / %d rows"), Row + NumRows, Settings.Size.Y);
+	}
+
+	const bool bSuccess = File->Close() && !File->IsError();
+	if (!bSuccess)
+	{
+		UE_LOG(LogPTG, Error, TEXT("Heightmap export: failed writing %s"), *_path);
+	}
+	return bSuccess;
+}
+
+/**
+ * @brief Generates the whole image at once
+ * @param OutPixels Output buffer of GetImageBytes bytes, rows from the first one
+ */
+void FHeightmapExporter::ExportToMemory(uint8* OutPixels) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FHeightmapExporter::ExportToMemory);
+
+	ExportRows(OutPixels, 0, Settings.Size.Y);
+}
+
+/**
+ * @brief Generates consecutive rows of the image, one parallel task per tile
+ * @param OutPixels Output buffer, receives _numRows rows of GetRowBytes bytes
+ * @param _firstRow First image row
+ * @param _numRows Number of rows
+ */
+void FHeightmapExporter::ExportRows(uint8* OutPixels, int32 _firstRow, int32 _numRows) const
+{
+	const int32 TileSize = Settings.TileSize;
+	const int32 Step = Settings.SampleStep;
+	const int32 NumTilesX = FMath::DivideAndRoundUp(Settings.Size.X, TileSize);
+	const int32 NumTilesY = FMath::DivideAndRoundUp(_numRows, TileSize);
+	const int32 BytesPerPixel = GetBytesPerPixel(Settings.Format);
+	const int64 RowBytes = GetRowBytes();
+
+	ParallelFor(NumTilesX * NumTilesY, [&](int32 TileIndex)
+	{
+		const int32 TileX = (TileIndex % NumTilesX) * TileSize;
+		const int32 TileY = (TileIndex / NumTilesX) * TileSize;
+		const int32 SizeX = FMath::Min(TileSize, Settings.Size.X - TileX);
+		const int32 SizeY = FMath::Min(TileSize, _numRows - TileY);
+
+		// Integer sample coordinates like the chunks, a sample gets the same value whatever tile evaluates it
+		const FVector2f Origin(Settings.Origin.X + TileX * Step, Settings.Origin.Y + (_firstRow + TileY) * Step);
+		FTerrainLayerGraph TileGraph = Graph;
+		TileGraph.BuildLattices(Origin, FTerrainLayerGraph::GetTileMaxCoordinates(Origin, Step, SizeX, SizeY));
+
+		TArray<float> Heights;
+		Heights.SetNumUninitialized(SizeX * SizeY);
+		TileGraph.EvaluateTile(Heights.GetData(), Origin, Step, SizeX, SizeY, SizeX);
+
+		for (int32 y = 0; y < SizeY; y++)
+		{
+			WritePixels(OutPixels + (TileY + y) * RowBytes + (int64)TileX * BytesPerPixel, Heights.GetData() + y * SizeX, SizeX);
+		}
+	});
+}
+
+/**
+ * @brief Converts heights to the export format
+ * @param OutPixels First output pixel
+ * @param _heights Heights in world units
+ * @param _count Number of pixels
+ */
+void FHeightmapExporter::WritePixels(uint8* OutPixels, const float* _heights, int32 _count) const
+{
+	if (Settings.Format == EHeightmapFormat::R32F)
+	{
+		FMemory::Memcpy(OutPixels, _heights, _count * sizeof(float));
+		return;
+	}
+
+	const float Min = Settings.HeightRange.X;
+	const float Scale = 65535.0f / FMath::Max(Settings.HeightRange.Y - Settings.HeightRange.X, UE_SMALL_NUMBER);
+	uint16* Pixels = reinterpret_cast<uint16*>(OutPixels);
+	for (int32 i = 0; i < _count; i++)
+	{
+		Pixels[i] = (uint16)FMath::Clamp(FMath::RoundToInt((_heights[i] - Min) * Scale), 0, 65535);
+	}
+}
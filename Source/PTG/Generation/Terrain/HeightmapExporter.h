@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTG/Generation/Terrain/ChunkData.h"
+#include "PTG/Generation/Terrain/TerrainLayerGraph.h"
+
+//////// CLASS ////////
+/// Evaluates the terrain layer graph over a heightmap, tiles are generated in parallel with the chunk generator kernels
+class PTG_API FHeightmapExporter
+{
+public:
+	//////// CONSTRUCTORS ////////
+	/**
+	 * @brief Compiles the layer graph of an export
+	 * @param _settings Region and format of the image
+	 * @param _terrainParameters Base height noise
+	 * @param _biomeParameters Biome mask noise
+	 * @param _layers Layers and height settings
+	 */
+	FHeightmapExporter(const FHeightmapExportSettings& _settings, const FPerlinParameters& _terrainParameters, const FPerlinParameters& _biomeParameters, const FTerrainLayerSettings& _layers);
+
+	//////// METHODS ////////
+	/// Export
+	bool ExportToFile(const FString& _path) const;
+	void ExportToMemory(uint8* OutPixels) const;
+
+	/// Getters
+	const FHeightmapExportSettings& GetSettings() const { return Settings; }
+	int64 GetRowBytes() const { return (int64)Settings.Size.X * GetBytesPerPixel(Settings.Format); }
+	int64 GetImageBytes() const { return GetRowBytes() * Settings.Size.Y; }
+
+	/// Helpers
+	static int32 GetBytesPerPixel(EHeightmapFormat _format) { return _format == EHeightmapFormat::R32F ? 4 : 2; }
+	static const TCHAR* GetFileExtension(EHeightmapFormat _format) { return _format == EHeightmapFormat::R32F ? TEXT("r32") : TEXT("r16"); }
+
+private:
+	//////// FIELDS ////////
+	FHeightmapExportSettings Settings;
+
+	/// Compiled once, copied by every tile for its own lattice caches
+	FTerrainLayerGraph Graph;
+
+	//////// METHODS ////////
+	void ExportRows(uint8* OutPixels, int32 _firstRow, int32 _numRows) const;
+	void WritePixels(uint8* OutPixels, const float* _heights, int32 _count) const;
+};
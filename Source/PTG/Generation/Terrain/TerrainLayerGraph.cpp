@@ -0,0 +1,204 @@
+#include "PTG/Generation/Terrain/TerrainLayerGraph.h"
+
+/**
+ * @file TerrainLayerGraph.cpp
+ * @brief Evaluation of the terrain noise layer graph
+ * @details Layers reading the same noise share its evaluation and its lattice caches, so the cost of a graph
+ *          grows with its distinct noises and not with its layers. Tiles are evaluated source by source with the
+ *          specialized tile kernels into small planes, then every sample is blended in a single pass
+ */
+
+FTerrainLayerGraph::FTerrainLayerGraph(const FPerlinParameters& _terrainParameters, const FPerlinParameters& _biomeParameters, const FTerrainLayerSettings& _settings)
+	: MaskRange(_settings.BiomeMaskRange), HeightScale(_settings.HeightScale), GradientPower(_settings.GradientPower), GradientSmoothing(_settings.GradientSmoothing)
+{
+	AddSource(_terrainParameters);
+
+	const bool bHasBiomes = _biomeParameters.Octaves > 0;
+	for (const FTerrainNoiseLayer& Layer : _settings.Layers)
+	{
+		const FPerlinParameters& Noise = Layer.Source == ETerrainLayerSource::Terrain ? _terrainParameters
+			: Layer.Source == ETerrainLayerSource::Biomes ? _biomeParameters : Layer.Noise;
+		if (Noise.Octaves <= 0)
+		{
+			continue;
+		}
+
+		FCompiledLayer& Compiled = Layers.AddDefaulted_GetRef();
+		Compiled.Source = AddSource(Noise);
+		Compiled.Shape = Layer.Shape;
+		Compiled.Blend = Layer.Blend;
+		Compiled.Amplitude = Layer.Amplitude;
+		Compiled.MaskInfluence = bHasBiomes ? FMath::Clamp(Layer.MaskInfluence, 0.0f, 1.0f) : 0.0f;
+		Compiled.bInvertMask = Layer.bInvertMask;
+
+		if (Compiled.MaskInfluence > 0.0f && MaskSource == INDEX_NONE)
+		{
+			MaskSource = AddSource(_biomeParameters);
+		}
+	}
+}
+
+/**
+ * @brief Returns the source evaluating a noise, added if the graph has none yet
+ * @param _noise Noise parameters, the height factor is not part of the noise
+ * @return Index of the source
+ */
+int32 FTerrainLayerGraph::AddSource(const FPerlinParameters& _noise)
+{
+	const int32 Existing = Sources.IndexOfByPredicate([&_noise](const FNoiseSource& Source)
+	{
+		return Source.Noise.Octaves == _noise.Octaves && Source.Noise.Frequency == _noise.Frequency && Source.Noise.Persistence == _noise.Persistence
+			&& Source.Noise.Seed == _noise.Seed && Source.Noise.Version == _noise.Version;
+	});
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+
+	FNoiseSource& Source = Sources.AddDefaulted_GetRef();
+	Source.Noise = _noise;
+	Source.Kernel = UPerlinNoise::GetSmoothedTileKernel(_noise.Octaves, _noise.Version);
+	return Sources.Num() - 1;
+}
+
+/**
+ * @brief Fills the lattice caches of every source
+ * @param _min Lowest sample coordinates of the region
+ * @param _max Highest sample coordinates of the region, see GetTileMaxCoordinates
+ */
+void FTerrainLayerGraph::BuildLattices(FVector2f _min, FVector2f _max)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainLayerGraph::BuildLattices);
+
+	for (FNoiseSource& Source : Sources)
+	{
+		Source.Lattice.Build(_min, _max, Source.Noise.Octaves, Source.Noise.Frequency, Source.Noise.Seed, Source.Noise.Version);
+	}
+
+	LatticeMin = _min;
+	LatticeMax = _max;
+	bHasLattices = true;
+}
+
+/**
+ * @brief Tells whether tiles of a region can be evaluated without building the lattice caches again
+ * @param _min Lowest sample coordinates of the region
+ * @param _max Highest sample coordinates of the region, see GetTileMaxCoordinates
+ * @return True if the last BuildLattices region contains it
+ */
+bool FTerrainLayerGraph::CoversRegion(FVector2f _min, FVector2f _max) const
+{
+	return bHasLattices && _min.X >= LatticeMin.X && _min.Y >= LatticeMin.Y && _max.X <= LatticeMax.X && _max.Y <= LatticeMax.Y;
+}
+
+/**
+ * @brief Fills a tile with final heights
+ * @param OutValues Output buffer, row y of the tile starts at OutValues[y * _stride]
+ * @param _origin Coordinates of the first sample
+ * @param _step Distance between two samples
+ * @param _sizeX Number of samples per row
+ * @param _sizeY Number of rows
+ * @param _stride Distance between two rows in the output buffer
+ * @details The tile must lie inside the region of the last BuildLattices call. The base noise is written straight to
+ *          the output, the other sources to planes sized to the tile so they stay in cache until the blend pass
+ */
+void FTerrainLayerGraph::EvaluateTile(float* OutValues, FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, int32 _stride)
+{
+	check(bHasLattices);
+
+	const int32 PlaneSize = _sizeX * _sizeY;
+	SourceValues.SetNumUninitialized((Sources.Num() - 1) * PlaneSize, EAllowShrinking::No);
+
+	for (int32 SourceIndex = 0; SourceIndex < Sources.Num(); SourceIndex++)
+	{
+		const FNoiseSource& Source = Sources[SourceIndex];
+		float* Values = SourceIndex == 0 ? OutValues : SourceValues.GetData() + (SourceIndex - 1) * PlaneSize;
+		Source.Kernel(Values, _origin, _step, _sizeX, _sizeY, SourceIndex == 0 ? _stride : _sizeX, Source.Noise.Octaves, Source.Noise.Persistence, Source.Noise.Frequency,
+			GradientPower, GradientSmoothing, SmoothingEpsilon, Source.Lattice);
+	}
+
+	if (IsBaseOnly())
+	{
+		for (int32 y = 0; y < _sizeY; y++)
+		{
+			float* Row = OutValues + y * _stride;
+			for (int32 x = 0; x < _sizeX; x++)
+			{
+				Row[x] *= HeightScale;
+			}
+		}
+		return;
+	}
+
+	TArray<float, TInlineAllocator<8>> Sample;
+	Sample.SetNumUninitialized(Sources.Num());
+	for (int32 y = 0; y < _sizeY; y++)
+	{
+		float* Row = OutValues + y * _stride;
+		for (int32 x = 0; x < _sizeX; x++)
+		{
+			Sample[0] = Row[x];
+			for (int32 SourceIndex = 1; SourceIndex < Sources.Num(); SourceIndex++)
+			{
+				Sample[SourceIndex] = SourceValues[(SourceIndex - 1) * PlaneSize + y * _sizeX + x];
+			}
+			Row[x] = CombineSample(Sample.GetData());
+		}
+	}
+}
+
+/**
+ * @brief Evaluates the final height of a single position
+ * @param _x X coordinate in full resolution samples
+ * @param _y Y coordinate in full resolution samples
+ * @return Height in world units, matches EvaluateTile up to float rounding
+ * @details Uses the scalar noise, no lattice cache is needed
+ */
+float FTerrainLayerGraph::EvaluateHeight(float _x, float _y) const
+{
+	TArray<float, TInlineAllocator<8>> Sample;
+	Sample.SetNumUninitialized(Sources.Num());
+	for (int32 SourceIndex = 0; SourceIndex < Sources.Num(); SourceIndex++)
+	{
+		const FPerlinParameters& Noise = Sources[SourceIndex].Noise;
+		Sample[SourceIndex] = UPerlinNoise::GenerateOctavePerlinSmoothed(_x, _y, Noise.Octaves, Noise.Persistence, Noise.Frequency, Noise.Seed,
+			GradientPower, GradientSmoothing, SmoothingEpsilon, Noise.Version);
+	}
+	return CombineSample(Sample.GetData());
+}
+
+/**
+ * @brief Blends the layers of one sample
+ * @param _values Noise value of every source at the sample
+ * @return Height in world units
+ */
+float FTerrainLayerGraph::CombineSample(const float* _values) const
+{
+	const float Mask = MaskSource != INDEX_NONE ? FMath::SmoothStep(MaskRange.X, MaskRange.Y, _values[MaskSource]) : 1.0f;
+	float Height = _values[0] * HeightScale;
+
+	for (const FCompiledLayer& Layer : Layers)
+	{
+		float Value = _values[Layer.Source];
+		switch (Layer.Shape)
+		{
+		case ETerrainLayerShape::Ridged: Value = 1.0f - FMath::Abs(2.0f * Value - 1.0f); break;
+		case ETerrainLayerShape::Billow: Value = FMath::Abs(2.0f * Value - 1.0f); break;
+		default: break;
+		}
+		Value *= Layer.Amplitude;
+
+		float Blended = Height;
+		switch (Layer.Blend)
+		{
+		case ETerrainLayerBlend::Add: Blended = Height + Value; break;
+		case ETerrainLayerBlend::Multiply: Blended = Height * Value; break;
+		case ETerrainLayerBlend::Max: Blended = FMath::Max(Height, Value); break;
+		case ETerrainLayerBlend::Min: Blended = FMath::Min(Height, Value); break;
+		}
+
+		const float Weight = FMath::Lerp(1.0f, Layer.bInvertMask ? 1.0f - Mask : Mask, Layer.MaskInfluence);
+		Height = FMath::Lerp(Height, Blended, Weight);
+	}
+	return Height;
+}
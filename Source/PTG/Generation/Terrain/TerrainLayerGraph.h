@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PTG/Generation/Terrain/ChunkData.h"
+#include "PTG/Generation/Utils/PerlinNoise.h"
+
+//////// CLASS ////////
+/// Layer graph compiled for evaluation, each distinct noise of the graph is evaluated once per sample whatever the number of layers reading it
+class PTG_API FTerrainLayerGraph
+{
+public:
+	//////// CONSTRUCTORS ////////
+	FTerrainLayerGraph() = default;
+
+	/**
+	 * @brief Compiles a layer graph
+	 * @param _terrainParameters Base height noise
+	 * @param _biomeParameters Biome mask noise, ignored when no layer reads the mask or without octaves
+	 * @param _settings Layers and height settings
+	 */
+	FTerrainLayerGraph(const FPerlinParameters& _terrainParameters, const FPerlinParameters& _biomeParameters, const FTerrainLayerSettings& _settings);
+
+	//////// METHODS ////////
+	/// Tile evaluation, one graph per worker
+	void BuildLattices(FVector2f _min, FVector2f _max);
+	bool CoversRegion(FVector2f _min, FVector2f _max) const;
+	void EvaluateTile(float* OutValues, FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, int32 _stride);
+
+	/// Single sample evaluation, thread safe
+	float EvaluateHeight(float _x, float _y) const;
+
+	/// Getters
+	int32 GetNumSources() const { return Sources.Num(); }
+	bool IsBaseOnly() const { return Layers.Num() == 0; }
+
+	/// Helpers
+	static FVector2f GetTileMaxCoordinates(FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY) { return UPerlinNoise::GetTileMaxCoordinates(_origin, _step, _sizeX, _sizeY, SmoothingEpsilon); }
+
+	/// Offset of the finite differences of the octave smoothing
+	static inline const FVector2D SmoothingEpsilon = FVector2D(1.0f / 64.0f);
+
+private:
+	//////// STRUCTS ////////
+	/// Distinct noise of the graph, source 0 is the base height
+	struct FNoiseSource
+	{
+		FPerlinParameters Noise;
+		FPerlinSmoothedTileKernel Kernel = nullptr;
+		FPerlinLatticeCache Lattice;
+	};
+
+	/// Layer reading the values of one source
+	struct FCompiledLayer
+	{
+		int32 Source = 0;
+		ETerrainLayerShape Shape = ETerrainLayerShape::Smooth;
+		ETerrainLayerBlend Blend = ETerrainLayerBlend::Add;
+		float Amplitude = 0.0f;
+		float MaskInfluence = 0.0f;
+		bool bInvertMask = false;
+	};
+
+	//////// FIELDS ////////
+	TArray<FNoiseSource, TInlineAllocator<4>> Sources;
+	TArray<FCompiledLayer, TInlineAllocator<4>> Layers;
+
+	/// Source of the biome mask, INDEX_NONE when no layer reads it
+	int32 MaskSource = INDEX_NONE;
+	FVector2f MaskRange = FVector2f(0.4f, 0.6f);
+
+	/// Shared by every source
+	float HeightScale = 100004.0f;
+	float GradientPower = 3.0f;
+	float GradientSmoothing = 0.9f;
+
+	/// Region covered by the lattice caches
+	FVector2f LatticeMin = FVector2f::ZeroVector;
+	FVector2f LatticeMax = FVector2f::ZeroVector;
+	bool bHasLattices = false;
+
+	/// Values of the sources besides the base one, one plane of a tile per source
+	TArray<float> SourceValues;
+
+	//////// METHODS ////////
+	int32 AddSource(const FPerlinParameters& _noise);
+	float CombineSample(const float* _values) const;
+};
@@ -0,0 +1,318 @@
+#include "PTG/Generation/Terrain/TerrainSnapshot.h"
+#include "PTG/PTG.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PTG/Generation/Terrain/ChunkThread.h"
+
+/**
+ * @file TerrainSnapshot.cpp
+ * @brief Implementation of the baked startup terrain
+ * @details A fixed header, one record per chunk, then the raw heights and aprons of every chunk. Chunks are baked with
+ *          the CPU generator stages, so the heights read back are the ones the workers would compute. Files are little
+ *          endian like every supported platform, they are meant to be packaged as non asset files
+ */
+
+//////// FILE FORMAT ////////
+/// Header of a snapshot
+struct FTerrainSnapshotHeader
+{
+	uint32 Magic;
+	uint16 Version;
+	uint16 Flags;
+	uint32 ParametersHash;
+	int32 ChunkSize;
+	int32 Radius;
+	int32 NumChunks;
+};
+
+/// Record of a baked chunk
+struct FTerrainSnapshotRecord
+{
+	int32 CellX;
+	int32 CellY;
+	int32 LOD;
+	float MinHeight;
+	float MaxHeight;
+	uint32 Padding;
+	int64 Offset;
+};
+
+static constexpr uint32 TerrainSnapshotMagic = 0x53475450; // "PTGS"
+
+/**
+ * @brief Number of floats stored for a chunk
+ * @param _chunkSize Size of chunk in full resolution samples
+ * @param _lod Level of detail of the chunk
+ * @return Height grid then one apron per border
+ */
+static int64 GetPayloadValueCount(int32 _chunkSize, int32 _lod)
+{
+	const int64 Resolution = FChunk::GetLODResolution(_chunkSize, _lod);
+	return Resolution * Resolution + (int32)EChunkBorder::Count * Resolution;
+}
+
+FTerrainSnapshot::~FTerrainSnapshot()
+{
+	// The region must be released before the file it maps
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+/**
+ * @brief Resolves a snapshot path of the streaming settings
+ * @param _path Absolute path or path relative to the project directory
+ * @return Absolute path, empty when _path is
+ */
+FString FTerrainSnapshot::ResolvePath(const FString& _path)
+{
+	if (_path.IsEmpty() || !FPaths::IsRelative(_path))
+	{
+		return _path;
+	}
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), _path);
+}
+
+/**
+ * @brief Opens a snapshot
+ * @param _path Snapshot file
+ * @return Snapshot, null if the file is missing, outdated or corrupted
+ * @details The file is memory mapped with a preload hint, chunks are only paged in when their job reads them
+ */
+FTerrainSnapshotPtr FTerrainSnapshot::Load(const FString& _path)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainSnapshot::Load);
+
+	TSharedRef<FTerrainSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FTerrainSnapshot, ESPMode::ThreadSafe>();
+
+	Snapshot->MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*_path));
+	if (Snapshot->MappedFile.IsValid())
+	{
+		Snapshot->MappedRegion.Reset(Snapshot->MappedFile->MapRegion(0, Snapshot->MappedFile->GetFileSize()));
+	}
+
+	if (Snapshot->MappedRegion.IsValid())
+	{
+		Snapshot->MappedRegion->PreloadHint();
+		Snapshot->Data = Snapshot->MappedRegion->GetMappedPtr();
+		Snapshot->DataSize = Snapshot->MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Snapshot->FileData, *_path, FILEREAD_Silent))
+	{
+		Snapshot->MappedFile.Reset();
+		Snapshot->Data = Snapshot->FileData.GetData();
+		Snapshot->DataSize = Snapshot->FileData.Num();
+	}
+	else
+	{
+		UE_LOG(LogPTG, Warning, TEXT("Terrain snapshot %s not found"), *_path);
+		return nullptr;
+	}
+
+	if (!Snapshot->Parse())
+	{
+		UE_LOG(LogPTG, Warning, TEXT("Terrain snapshot %s is outdated or corrupted"), *_path);
+		return nullptr;
+	}
+
+	UE_LOG(LogPTG, Log, TEXT("Terrain snapshot %s: %d chunks, radius %d, parameters %08x"), *_path, Snapshot->GetNumChunks(), Snapshot->Radius, Snapshot->ParametersHash);
+	return Snapshot;
+}
+
+/**
+ * @brief Opens a snapshot on the thread pool
+ * @param _path Snapshot file
+ * @return Future snapshot, null on failure
+ */
+TFuture<FTerrainSnapshotPtr> FTerrainSnapshot::LoadAsync(const FString& _path)
+{
+	return Async(EAsyncExecution::ThreadPool, [_path]() { return Load(_path); });
+}
+
+/**
+ * @brief Validates the file and indexes its chunks
+ * @return False if the file is truncated or of another format version
+ */
+bool FTerrainSnapshot::Parse()
+{
+	if (DataSize < (int64)sizeof(FTerrainSnapshotHeader))
+	{
+		return false;
+	}
+
+	FTerrainSnapshotHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(FTerrainSnapshotHeader));
+	if (Header.Magic != TerrainSnapshotMagic || Header.Version != FormatVersion || Header.ChunkSize < 2 || Header.NumChunks < 0
+		|| sizeof(FTerrainSnapshotHeader) + (int64)Header.NumChunks * sizeof(FTerrainSnapshotRecord) > DataSize)
+	{
+		return false;
+	}
+
+	ParametersHash = Header.ParametersHash;
+	ChunkSize = Header.ChunkSize;
+	Radius = Header.Radius;
+	Entries.Reserve(Header.NumChunks);
+
+	const uint8* Records = Data + sizeof(FTerrainSnapshotHeader);
+	for (int32 i = 0; i < Header.NumChunks; i++)
+	{
+		FTerrainSnapshotRecord Record;
+		FMemory::Memcpy(&Record, Records + i * sizeof(FTerrainSnapshotRecord), sizeof(FTerrainSnapshotRecord));
+		if (Record.LOD < 0 || Record.LOD > 3 || Record.Offset < 0
+			|| Record.Offset + GetPayloadValueCount(ChunkSize, Record.LOD) * (int64)sizeof(float) > DataSize)
+		{
+			return false;
+		}
+
+		FEntry& Entry = Entries.Add(ChunkData::GetChunkIdFromCoordinates(Record.CellX * (ChunkSize - 1), Record.CellY * (ChunkSize - 1)));
+		Entry.LOD = Record.LOD;
+		Entry.MinHeight = Record.MinHeight;
+		Entry.MaxHeight = Record.MaxHeight;
+		Entry.Offset = Record.Offset;
+	}
+	return true;
+}
+
+/**
+ * @brief Tells whether a chunk can be read from the snapshot
+ * @param Chunk Chunk with its size, LOD, id and parameters hash set
+ * @return True if the snapshot holds it at this LOD with the same parameters
+ */
+bool FTerrainSnapshot::Contains(const FChunk& Chunk) const
+{
+	const FEntry* Entry = Entries.Find(Chunk.Id);
+	return Entry && Entry->LOD == Chunk.LOD && Chunk.Size == ChunkSize && Chunk.ParametersHash == ParametersHash;
+}
+
+/**
+ * @brief Fills a chunk with its baked heights
+ * @param Chunk Chunk with its size, LOD, id and parameters hash set, receives the height grid
+ * @param OutApronHeights Receives the heights one vertex outside each edge, indexed by EChunkBorder
+ * @return False if the snapshot does not hold the chunk, see Contains
+ * @details Called by the workers, the copy is what pages the chunk in
+ */
+bool FTerrainSnapshot::FillChunk(FChunk& Chunk, TArray<float> (&OutApronHeights)[(int32)EChunkBorder::Count]) const
+{
+	if (!Contains(Chunk))
+	{
+		return false;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainSnapshot::FillChunk);
+
+	const FEntry& Entry = Entries.FindChecked(Chunk.Id);
+	const int32 Resolution = Chunk.GetResolution();
+	const float* Values = reinterpret_cast<const float*>(Data + Entry.Offset);
+
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(Resolution * Resolution);
+	FMemory::Memcpy(Heights.GetData(), Values, Heights.Num() * sizeof(float));
+	Values += Heights.Num();
+
+	for (TArray<float>& Apron : OutApronHeights)
+	{
+		Apron.SetNumUninitialized(Resolution);
+		FMemory::Memcpy(Apron.GetData(), Values, Resolution * sizeof(float));
+		Values += Resolution;
+	}
+
+	Chunk.HeightData = MakeShared<FChunkHeights, ESPMode::ThreadSafe>(MoveTemp(Heights), Entry.MinHeight, Entry.MaxHeight);
+	return true;
+}
+
+/**
+ * @brief Generates the chunks around the spawn and writes them to a snapshot
+ * @param _path Output file
+ * @param _chunkSize Size of chunks in full resolution samples
+ * @param _radius Rings of chunks around the spawn chunk
+ * @param _terrainParameters Base height noise
+ * @param _biomeParameters Biome mask noise
+ * @param _layers Layers and height settings
+ * @param _streamingSettings Streaming settings of the game, chunks are baked at the LOD of their ring
+ * @return False if the file could not be written
+ * @details Chunks are generated in parallel, each on its own with the noise and apron stages of the workers
+ */
+bool FTerrainSnapshot::Bake(const FString& _path, int32 _chunkSize, int32 _radius, const FPerlinParameters& _terrainParameters, const FPerlinParameters& _biomeParameters,
+	const FTerrainLayerSettings& _layers, const FChunkStreamingSettings& _streamingSettings)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainSnapshot::Bake);
+
+	const int32 Side = 2 * _radius + 1;
+	const int32 NumChunks = Side * Side;
+	const uint32 BakedParametersHash = ChunkData::GetParametersHash(_terrainParameters, _biomeParameters, _layers, _chunkSize);
+	const FTerrainLayerSettingsPtr LayerSettings = MakeShared<const FTerrainLayerSettings, ESPMode::ThreadSafe>(_layers);
+
+	TArray<FTerrainSnapshotRecord> Records;
+	Records.SetNumZeroed(NumChunks);
+	TArray<TArray<float>> Payloads;
+	Payloads.SetNum(NumChunks);
+
+	ParallelFor(NumChunks, [&](int32 Index)
+	{
+		const FIntPoint Cell(Index % Side - _radius, Index / Side - _radius);
+
+		FChunk Chunk;
+		Chunk.Size = _chunkSize;
+		Chunk.LOD = ChunkData::GetRingLOD(FMath::Max(FMath::Abs(Cell.X), FMath::Abs(Cell.Y)), _chunkSize, _streamingSettings);
+		Chunk.Coords = FVector(Cell.X * (_chunkSize - 1), Cell.Y * (_chunkSize - 1), 0);
+		Chunk.Id = ChunkData::GetChunkIdFromCoordinates(Chunk.Coords.X, Chunk.Coords.Y);
+		Chunk.ParametersHash = BakedParametersHash;
+
+		FChunkJob Job(Chunk, _terrainParameters, _biomeParameters, 0.0f);
+		Job.LayerSettings = LayerSettings;
+		FChunkThread::GenerateChunk(Job);
+		FChunkThread::GenerateApron(Job);
+
+		FTerrainSnapshotRecord& Record = Records[Index];
+		Record.CellX = Cell.X;
+		Record.CellY = Cell.Y;
+		Record.LOD = Job.Chunk.LOD;
+		Record.MinHeight = Job.Chunk.GetMinHeight();
+		Record.MaxHeight = Job.Chunk.GetMaxHeight();
+
+		TArray<float>& Payload = Payloads[Index];
+		Payload.Reserve((int32)GetPayloadValueCount(_chunkSize, Job.Chunk.LOD));
+		Payload.Append(Job.Chunk.GetHeights());
+		for (const TArray<float>& Apron : Job.ApronHeights)
+		{
+			Payload.Append(Apron);
+		}
+	});
+
+	FTerrainSnapshotHeader Header;
+	Header.Magic = TerrainSnapshotMagic;
+	Header.Version = FormatVersion;
+	Header.Flags = 0;
+	Header.ParametersHash = BakedParametersHash;
+	Header.ChunkSize = _chunkSize;
+	Header.Radius = _radius;
+	Header.NumChunks = NumChunks;
+
+	int64 Offset = sizeof(FTerrainSnapshotHeader) + (int64)NumChunks * sizeof(FTerrainSnapshotRecord);
+	for (int32 i = 0; i < NumChunks; i++)
+	{
+		Records[i].Offset = Offset;
+		Offset += Payloads[i].Num() * sizeof(float);
+	}
+
+	TArray64<uint8> FileData;
+	FileData.Reserve(Offset);
+	FileData.Append(reinterpret_cast<const uint8*>(&Header), sizeof(FTerrainSnapshotHeader));
+	FileData.Append(reinterpret_cast<const uint8*>(Records.GetData()), Records.Num() * sizeof(FTerrainSnapshotRecord));
+	for (const TArray<float>& Payload : Payloads)
+	{
+		FileData.Append(reinterpret_cast<const uint8*>(Payload.GetData()), Payload.Num() * sizeof(float));
+	}
+
+	if (!FFileHelper::SaveArrayToFile(FileData, *_path))
+	{
+		UE_LOG(LogPTG, Error, TEXT("Failed writing terrain snapshot %s"), *_path);
+		return false;
+	}
+
+	UE_LOG(LogPTG, Display, TEXT("Terrain snapshot %s: %d chunks, radius %d, parameters %08x, %lld bytes"), *_path, NumChunks, _radius, BakedParametersHash, FileData.Num());
+	return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "PTG/Generation/Terrain/ChunkData.h"
+
+//////// FORWARD DECLARATION ////////
+/// Class
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+//////// CLASS ////////
+/// Baked height grids and aprons of the chunks around the spawn, read from a memory mapped file so their jobs skip the noise stages
+class PTG_API FTerrainSnapshot
+{
+public:
+	//////// CONSTRUCTORS ////////
+	FTerrainSnapshot() = default;
+	~FTerrainSnapshot();
+
+	//////// METHODS ////////
+	/// Loading
+	static TSharedPtr<const FTerrainSnapshot, ESPMode::ThreadSafe> Load(const FString& _path);
+	static TFuture<TSharedPtr<const FTerrainSnapshot, ESPMode::ThreadSafe>> LoadAsync(const FString& _path);
+
+	/// Baking
+	static bool Bake(const FString& _path, int32 _chunkSize, int32 _radius, const FPerlinParameters& _terrainParameters, const FPerlinParameters& _biomeParameters,
+		const FTerrainLayerSettings& _layers, const FChunkStreamingSettings& _streamingSettings);
+
+	/// Chunks, thread safe
+	bool Contains(const FChunk& Chunk) const;
+	bool FillChunk(FChunk& Chunk, TArray<float> (&OutApronHeights)[(int32)EChunkBorder::Count]) const;
+
+	/// Getters
+	uint32 GetParametersHash() const { return ParametersHash; }
+	int32 GetChunkSize() const { return ChunkSize; }
+	int32 GetRadius() const { return Radius; }
+	int32 GetNumChunks() const { return Entries.Num(); }
+
+	/// Helpers
+	static FString ResolvePath(const FString& _path);
+
+	/// Bumped whenever the file layout or the generated heights change, older snapshots are ignored
+	static constexpr uint16 FormatVersion = 1;
+
+private:
+	//////// STRUCTS ////////
+	/// Baked chunk, its heights then its four aprons are stored at Offset
+	struct FEntry
+	{
+		int32 LOD = 0;
+		float MinHeight = 0.0f;
+		float MaxHeight = 0.0f;
+		int64 Offset = 0;
+	};
+
+	//////// FIELDS ////////
+	/// Baked chunks by chunk id
+	TMap<int64, FEntry> Entries;
+	uint32 ParametersHash = 0;
+	int32 ChunkSize = 0;
+	int32 Radius = 0;
+
+	/// File contents, mapped when the platform supports it, read in memory otherwise
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray64<uint8> FileData;
+	const uint8* Data = nullptr;
+	int64 DataSize = 0;
+
+	//////// METHODS ////////
+	bool Parse();
+};
+
+typedef TSharedPtr<const FTerrainSnapshot, ESPMode::ThreadSafe> FTerrainSnapshotPtr;
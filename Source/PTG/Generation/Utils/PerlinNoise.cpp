@@ -1,4 +1,6 @@
 #include "PTG/Generation/Utils/PerlinNoise.h"
+#include "PTG/PTG.h"
+#include "PTG/Generation/Terrain/HeightmapExporter.h"
 
 // Core includes
 #include "CoreMinimal.h"
@@ -13,6 +15,9 @@
 // File system and path handling
 #include "Misc/Paths.h"
 #include "Misc/PackageName.h"
+
+// Batch noise
+#include "Math/VectorRegister.h"
 #include<random>
 #include<cmath>
 
@@ -27,6 +32,263 @@
  * @details Provides various noise generation methods for terrain and texture creation
  */
 
+//////// SIMD HELPERS ////////
+namespace PerlinNoiseSimd
+{
+    /// Number of samples evaluated at once
+    constexpr int32 LaneCount = UPerlinNoise::TileLaneCount;
+
+    FORCEINLINE VectorRegister4Float Fade(const VectorRegister4Float& T)
+    {
+        // ((t * 6 - 15) * t + 10) * t^3
+        VectorRegister4Float Result = VectorMultiplyAdd(T, VectorSetFloat1(6.0f), VectorSetFloat1(-15.0f));
+        Result = VectorMultiplyAdd(Result, T, VectorSetFloat1(10.0f));
+        return VectorMultiply(Result, VectorMultiply(T, VectorMultiply(T, T)));
+    }
+
+    FORCEINLINE VectorRegister4Float Lerp(const VectorRegister4Float& A, const VectorRegister4Float& B, const VectorRegister4Float& Alpha)
+    {
+        return VectorMultiplyAdd(Alpha, VectorSubtract(B, A), A);
+    }
+
+    /// Maps a noise value from [-1, 1] to [0, 1], like FMath::GetMappedRangeValueClamped
+    FORCEINLINE VectorRegister4Float MapToUnitRange(const VectorRegister4Float& Value)
+    {
+        const VectorRegister4Float Mapped = VectorMultiply(VectorAdd(Value, VectorOne()), VectorSetFloat1(0.5f));
+        return VectorMin(VectorMax(Mapped, VectorZero()), VectorOne());
+    }
+
+    /// Fade curve derivative, 30 * t^2 * (t - 1)^2
+    FORCEINLINE VectorRegister4Float FadeDerivative(const VectorRegister4Float& T)
+    {
+        const VectorRegister4Float T1 = VectorSubtract(T, VectorOne());
+        return VectorMultiply(VectorSetFloat1(30.0f), VectorMultiply(VectorMultiply(T, T), VectorMultiply(T1, T1)));
+    }
+
+    /// Position inside the lattice cell and corner gradients of four samples
+    struct FCellLanes
+    {
+        VectorRegister4Float Sx;
+        VectorRegister4Float Sy;
+        VectorRegister4Float GradientX[4];
+        VectorRegister4Float GradientY[4];
+    };
+
+    /**
+     * @brief Locates four samples in the lattice of an octave and fetches their corner gradients
+     * @details Corners are ordered (x0, y0), (x1, y0), (x0, y1), (x1, y1), gradients are read per lane from the octave cache
+     */
+    FORCEINLINE void LoadCell(const VectorRegister4Float& _x, const VectorRegister4Float& _y, float _frequency, const FLatticeGradientCache& _lattice, FCellLanes& OutCell)
+    {
+        const VectorRegister4Float Frequency = VectorSetFloat1(_frequency);
+        const VectorRegister4Float X = VectorMultiply(_x, Frequency);
+        const VectorRegister4Float Y = VectorMultiply(_y, Frequency);
+        const VectorRegister4Float X0 = VectorFloor(X);
+        const VectorRegister4Float Y0 = VectorFloor(Y);
+
+        alignas(16) float X0Lanes[LaneCount];
+        alignas(16) float Y0Lanes[LaneCount];
+        VectorStoreAligned(X0, X0Lanes);
+        VectorStoreAligned(Y0, Y0Lanes);
+
+        // Gradients of the four cell corners, X then Y component, one lane per sample
+        alignas(16) float Gradients[8][LaneCount];
+        for (int32 Lane = 0; Lane < LaneCount; Lane++)
+        {
+            const int32 x0 = static_cast<int32>(X0Lanes[Lane]);
+            const int32 y0 = static_cast<int32>(Y0Lanes[Lane]);
+
+            for (int32 Corner = 0; Corner < 4; Corner++)
+            {
+                const FVector2f& Gradient = _lattice.Get(x0 + (Corner & 1), y0 + (Corner >> 1));
+                Gradients[Corner * 2][Lane] = Gradient.X;
+                Gradients[Corner * 2 + 1][Lane] = Gradient.Y;
+            }
+        }
+
+        OutCell.Sx = VectorSubtract(X, X0);
+        OutCell.Sy = VectorSubtract(Y, Y0);
+        for (int32 Corner = 0; Corner < 4; Corner++)
+        {
+            OutCell.GradientX[Corner] = VectorLoadAligned(Gradients[Corner * 2]);
+            OutCell.GradientY[Corner] = VectorLoadAligned(Gradients[Corner * 2 + 1]);
+        }
+    }
+
+    /// Dot products between the corner gradients and the offsets to the sample
+    FORCEINLINE void CornerDots(const FCellLanes& Cell, VectorRegister4Float& a1, VectorRegister4Float& a2, VectorRegister4Float& a3, VectorRegister4Float& a4)
+    {
+        const VectorRegister4Float Sx1 = VectorSubtract(Cell.Sx, VectorOne());
+        const VectorRegister4Float Sy1 = VectorSubtract(Cell.Sy, VectorOne());
+
+        a1 = VectorMultiplyAdd(Cell.Sx, Cell.GradientX[0], VectorMultiply(Cell.Sy, Cell.GradientY[0]));
+        a2 = VectorMultiplyAdd(Sx1, Cell.GradientX[1], VectorMultiply(Cell.Sy, Cell.GradientY[1]));
+        a3 = VectorMultiplyAdd(Cell.Sx, Cell.GradientX[2], VectorMultiply(Sy1, Cell.GradientY[2]));
+        a4 = VectorMultiplyAdd(Sx1, Cell.GradientX[3], VectorMultiply(Sy1, Cell.GradientY[3]));
+    }
+
+    /**
+     * @brief Lane-wise equivalent of UPerlinNoise::GeneratePerlinValue
+     * @details Interpolation runs in vector registers, the lattice gradients are fetched per lane
+     */
+    VectorRegister4Float GeneratePerlinValue(const VectorRegister4Float& _x, const VectorRegister4Float& _y, float _frequency, const FLatticeGradientCache& _lattice)
+    {
+        FCellLanes Cell;
+        LoadCell(_x, _y, _frequency, _lattice, Cell);
+
+        VectorRegister4Float a1, a2, a3, a4;
+        CornerDots(Cell, a1, a2, a3, a4);
+
+        const VectorRegister4Float u = Fade(Cell.Sx);
+        const VectorRegister4Float b1 = Lerp(a1, a2, u);
+        const VectorRegister4Float b2 = Lerp(a3, a4, u);
+        return Lerp(b1, b2, Fade(Cell.Sy));
+    }
+
+    /**
+     * @brief Lane-wise equivalent of UPerlinNoise::GeneratePerlinValueWithDerivative
+     */
+    VectorRegister4Float GeneratePerlinValueWithDerivative(const VectorRegister4Float& _x, const VectorRegister4Float& _y, float _frequency, const FLatticeGradientCache& _lattice, VectorRegister4Float& OutDerivativeX, VectorRegister4Float& OutDerivativeY)
+    {
+        FCellLanes Cell;
+        LoadCell(_x, _y, _frequency, _lattice, Cell);
+
+        VectorRegister4Float a1, a2, a3, a4;
+        CornerDots(Cell, a1, a2, a3, a4);
+
+        const VectorRegister4Float u = Fade(Cell.Sx);
+        const VectorRegister4Float v = Fade(Cell.Sy);
+        const VectorRegister4Float k1 = VectorSubtract(a2, a1);
+        const VectorRegister4Float k2 = VectorSubtract(a3, a1);
+        const VectorRegister4Float k3 = VectorAdd(VectorSubtract(a1, a2), VectorSubtract(a4, a3));
+
+        // d/ds of the bilinear blend: interpolated gradients plus the fade curve contribution
+        const VectorRegister4Float Frequency = VectorSetFloat1(_frequency);
+        const VectorRegister4Float GradientX = Lerp(Lerp(Cell.GradientX[0], Cell.GradientX[1], u), Lerp(Cell.GradientX[2], Cell.GradientX[3], u), v);
+        const VectorRegister4Float GradientY = Lerp(Lerp(Cell.GradientY[0], Cell.GradientY[1], u), Lerp(Cell.GradientY[2], Cell.GradientY[3], u), v);
+        OutDerivativeX = VectorMultiply(VectorMultiplyAdd(FadeDerivative(Cell.Sx), VectorMultiplyAdd(k3, v, k1), GradientX), Frequency);
+        OutDerivativeY = VectorMultiply(VectorMultiplyAdd(FadeDerivative(Cell.Sy), VectorMultiplyAdd(k3, u, k2), GradientY), Frequency);
+
+        const VectorRegister4Float b1 = Lerp(a1, a2, u);
+        const VectorRegister4Float b2 = Lerp(a3, a4, u);
+        return Lerp(b1, b2, v);
+    }
+
+    /**
+     * @brief Body of UPerlinNoise::GenerateOctavePerlinSmoothedTile
+     * @tparam NumOctaves Octave count fixed at compile time so the octave loop is unrolled, 0 reads it from _octaves
+     * @tparam bAnalytic Smoothing driven by the analytic derivative instead of finite differences
+     * @details Selected once per job with UPerlinNoise::GetSmoothedTileKernel, see GenerateOctavePerlinSmoothedTile for the parameters
+     */
+    template<int32 NumOctaves, bool bAnalytic>
+    void SmoothedTileKernel(float* OutValues, FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, int32 _stride, int32 _octaves, float _persistence, float _frequency, float _gradientPower, float _gradientSmoothing, FVector2D eps, const FPerlinLatticeCache& _lattice)
+    {
+        TRACE_CPUPROFILER_EVENT_SCOPE(PerlinNoiseSimd::SmoothedTileKernel);
+        SCOPE_CYCLE_COUNTER(STAT_PTG_NoiseTile);
+
+        const int32 Octaves = NumOctaves > 0 ? NumOctaves : _octaves;
+        check(_lattice.Octaves.Num() >= Octaves);
+
+        // Octave caches looked up once per tile, on the stack when the count is fixed
+        TArray<const FLatticeGradientCache*, TInlineAllocator<(NumOctaves > 0 ? NumOctaves : 8)>> OctaveLattices;
+        for (int32 i = 0; i < Octaves; i++)
+        {
+            OctaveLattices.Add(&_lattice.Octaves[i]);
+        }
+
+        const VectorRegister4Float One = VectorOne();
+        const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+        const VectorRegister4Float EpsX = VectorSetFloat1(static_cast<float>(eps.X));
+        const VectorRegister4Float EpsY = VectorSetFloat1(static_cast<float>(eps.Y));
+        const VectorRegister4Float GradientPower = VectorSetFloat1(_gradientPower);
+        const VectorRegister4Float GradientSmoothing = VectorSetFloat1(_gradientSmoothing);
+        const VectorRegister4Float Persistence = VectorSetFloat1(_persistence);
+
+        for (int32 y = 0; y < _sizeY; y++)
+        {
+            const VectorRegister4Float Y = VectorSetFloat1(_origin.Y + y * _step);
+            const VectorRegister4Float YEps = VectorAdd(Y, EpsY);
+            float* Row = OutValues + y * _stride;
+
+            for (int32 x = 0; x < _sizeX; x += LaneCount)
+            {
+                const VectorRegister4Float X = MakeVectorRegister(
+                    _origin.X + x * _step,
+                    _origin.X + (x + 1) * _step,
+                    _origin.X + (x + 2) * _step,
+                    _origin.X + (x + 3) * _step);
+                const VectorRegister4Float XEps = VectorAdd(X, EpsX);
+
+                VectorRegister4Float Total = VectorZero();
+                VectorRegister4Float Amplitude = One;
+                VectorRegister4Float MaxValue = VectorZero();
+                VectorRegister4Float GradientSumX = VectorZero();
+                VectorRegister4Float GradientSumY = VectorZero();
+                float Frequency = _frequency;
+
+                for (int32 i = 0; i < Octaves; i++)
+                {
+                    const FLatticeGradientCache& Lattice = *OctaveLattices[i];
+                    VectorRegister4Float p00;
+                    if constexpr (bAnalytic)
+                    {
+                        VectorRegister4Float DerivativeX, DerivativeY;
+                        p00 = MapToUnitRange(PerlinNoiseSimd::GeneratePerlinValueWithDerivative(X, Y, Frequency, Lattice, DerivativeX, DerivativeY));
+
+                        GradientSumX = VectorMultiplyAdd(DerivativeX, Half, GradientSumX);
+                        GradientSumY = VectorMultiplyAdd(DerivativeY, Half, GradientSumY);
+                    }
+                    else
+                    {
+                        p00 = MapToUnitRange(PerlinNoiseSimd::GeneratePerlinValue(X, Y, Frequency, Lattice));
+                        const VectorRegister4Float p10 = MapToUnitRange(PerlinNoiseSimd::GeneratePerlinValue(XEps, Y, Frequency, Lattice));
+                        const VectorRegister4Float p01 = MapToUnitRange(PerlinNoiseSimd::GeneratePerlinValue(X, YEps, Frequency, Lattice));
+
+                        GradientSumX = VectorAdd(GradientSumX, VectorDivide(VectorSubtract(p10, p00), EpsX));
+                        GradientSumY = VectorAdd(GradientSumY, VectorDivide(VectorSubtract(p01, p00), EpsY));
+                    }
+                    const VectorRegister4Float GradientMagnitude = VectorSqrt(VectorMultiplyAdd(GradientSumX, GradientSumX, VectorMultiply(GradientSumY, GradientSumY)));
+                    const VectorRegister4Float LayerInfluence = VectorDivide(One, VectorMultiplyAdd(GradientPower, GradientMagnitude, One));
+
+                    Total = VectorMultiplyAdd(VectorMultiply(p00, Amplitude), LayerInfluence, Total);
+                    Frequency = Frequency * 2.0f;
+                    MaxValue = VectorAdd(MaxValue, Amplitude);
+                    Amplitude = VectorMultiply(Amplitude, VectorMultiply(Persistence, Lerp(One, VectorSubtract(One, GradientMagnitude), GradientSmoothing)));
+                }
+
+                const VectorRegister4Float Result = VectorDivide(Total, MaxValue);
+                if (x + LaneCount <= _sizeX)
+                {
+                    VectorStore(Result, Row + x);
+                }
+                else
+                {
+                    alignas(16) float Lanes[LaneCount];
+                    VectorStoreAligned(Result, Lanes);
+                    FMemory::Memcpy(Row + x, Lanes, (_sizeX - x) * sizeof(float));
+                }
+            }
+        }
+    }
+
+    /// Specialized kernels of the octave counts used by shipped configurations
+    template<bool bAnalytic>
+    FPerlinSmoothedTileKernel SelectSmoothedTileKernel(int32 _octaves)
+    {
+        switch (_octaves)
+        {
+        case 2: return &SmoothedTileKernel<2, bAnalytic>;
+        case 3: return &SmoothedTileKernel<3, bAnalytic>;
+        case 4: return &SmoothedTileKernel<4, bAnalytic>;
+        case 5: return &SmoothedTileKernel<5, bAnalytic>;
+        case 6: return &SmoothedTileKernel<6, bAnalytic>;
+        case 7: return &SmoothedTileKernel<7, bAnalytic>;
+        case 8: return &SmoothedTileKernel<8, bAnalytic>;
+        default: return &SmoothedTileKernel<0, bAnalytic>;
+        }
+    }
+}
+
 UPerlinNoise::UPerlinNoise()
 {
     
@@ -65,9 +327,10 @@ float UPerlinNoise::DotValue(FVector gradient_vector, int x1, int y1, float x, f
  * @param _persistence Persistence between octaves
  * @param _frequency Base frequency of noise
  * @param _seed Random seed
+ * @param _version Gradient generation scheme
  * @return Combined noise value
  */
-float UPerlinNoise::GenerateOctavePerlinValue(float _x, float _y, int32 _octaves, float _persistence, float _frequency,int _seed)
+float UPerlinNoise::GenerateOctavePerlinValue(float _x, float _y, int32 _octaves, float _persistence, float _frequency,int _seed, EPerlinNoiseVersion _version)
 {
     float total = 0.0;
     float amplitude = 1.0;
@@ -75,7 +338,7 @@ float UPerlinNoise::GenerateOctavePerlinValue(float _x, float _y, int32 _octaves
 
     for (int i = 0; i < _octaves; i++)
     {
-        total += FMath::Pow(FMath::GetMappedRangeValueClamped(FVector2D(-1,1),FVector2D(0,1),GeneratePerlinValue(_x, _y, i, _frequency, _seed))*1.35,7)* amplitude;
+        total += FMath::Pow(FMath::GetMappedRangeValueClamped(FVector2D(-1,1),FVector2D(0,1),GeneratePerlinValue(_x, _y, i, _frequency, _seed, _version))*1.35,7)* amplitude;
         _frequency = _frequency * 2.0;
         maxValue += amplitude;
         amplitude *= _persistence;
@@ -96,10 +359,11 @@ float UPerlinNoise::GenerateOctavePerlinValue(float _x, float _y, int32 _octaves
  * @param _seed Random seed
  * @param _gradientPower Influence of gradient on noise
  * @param _gradientSmoothing Smoothing factor for gradient transitions
- * @param eps Small value for gradient calculation
+ * @param eps Small value for gradient calculation, unused by EPerlinNoiseVersion::HashedAnalytic
+ * @param _version Gradient generation scheme
  * @return Smoothed noise value
  */
-float UPerlinNoise::GenerateOctavePerlinSmoothed(float _x, float _y, int32 _octaves, float _persistence, float _frequency, int _seed, float _gradientPower, float _gradientSmoothing,FVector2D eps)
+float UPerlinNoise::GenerateOctavePerlinSmoothed(float _x, float _y, int32 _octaves, float _persistence, float _frequency, int _seed, float _gradientPower, float _gradientSmoothing,FVector2D eps, EPerlinNoiseVersion _version)
 {
     float total = 0.0;
     float amplitude = 1.0;
@@ -109,11 +373,24 @@ float UPerlinNoise::GenerateOctavePerlinSmoothed(float _x, float _y, int32 _octa
 
     for (int i = 0; i < _octaves; i++)
     {
-        float p00 = FMath::GetMappedRangeValueClamped(FVector2D(-1, 1), FVector2D(0, 1), GeneratePerlinValue(_x, _y, i, _frequency, _seed));
-        float p10 = FMath::GetMappedRangeValueClamped(FVector2D(-1, 1), FVector2D(0, 1), GeneratePerlinValue(_x + eps.X, _y, i, _frequency, _seed));
-        float p01 = FMath::GetMappedRangeValueClamped(FVector2D(-1, 1), FVector2D(0, 1), GeneratePerlinValue(_x, _y + eps.Y, i, _frequency, _seed));
+        float p00;
+        FVector2D gradient;
+
+        if (_version == EPerlinNoiseVersion::HashedAnalytic)
+        {
+            // The [-1, 1] to [0, 1] mapping halves the derivative, noise never reaches the clamped range
+            FVector2f derivative;
+            p00 = FMath::GetMappedRangeValueClamped(FVector2D(-1, 1), FVector2D(0, 1), GeneratePerlinValueWithDerivative(_x, _y, i, _frequency, _seed, derivative, _version));
+            gradient = FVector2D(derivative.X * 0.5f, derivative.Y * 0.5f);
+        }
+        else
+        {
+            p00 = FMath::GetMappedRangeValueClamped(FVector2D(-1, 1), FVector2D(0, 1), GeneratePerlinValue(_x, _y, i, _frequency, _seed, _version));
+            float p10 = FMath::GetMappedRangeValueClamped(FVector2D(-1, 1), FVector2D(0, 1), GeneratePerlinValue(_x + eps.X, _y, i, _frequency, _seed, _version));
+            float p01 = FMath::GetMappedRangeValueClamped(FVector2D(-1, 1), FVector2D(0, 1), GeneratePerlinValue(_x, _y + eps.Y, i, _frequency, _seed, _version));
+            gradient = FVector2D(p10 - p00, p01 - p00) / eps;
+        }
 
-        FVector2D gradient = FVector2D(p10 - p00, p01 - p00) / eps;
         gradientSum += gradient;
         float gradientMagnitude = gradientSum.Length();
         float layerInfluence = (1.0f / (1.0f + _gradientPower * gradientMagnitude));
@@ -128,6 +405,126 @@ float UPerlinNoise::GenerateOctavePerlinSmoothed(float _x, float _y, int32 _octa
     return total / maxValue;
 }
 
+/**
+ * @brief Fills a tile of smoothed multi-octave Perlin noise
+ * @param OutValues Output buffer, row y of the tile starts at OutValues[y * _stride]
+ * @param _origin Coordinates of the first sample
+ * @param _step Distance between two samples
+ * @param _sizeX Number of samples per row
+ * @param _sizeY Number of rows
+ * @param _stride Distance between two rows in the output buffer
+ * @param _octaves Number of noise octaves
+ * @param _persistence Persistence between octaves
+ * @param _frequency Base frequency of noise
+ * @param _seed Random seed
+ * @param _gradientPower Influence of gradient on noise
+ * @param _gradientSmoothing Smoothing factor for gradient transitions
+ * @param eps Small value for gradient calculation
+ * @param _version Gradient generation scheme
+ * @param _lattice Gradient caches covering the tile, built from _origin and GetTileMaxCoordinates when null
+ * @details Vectorized GenerateOctavePerlinSmoothed evaluating PerlinNoiseSimd::LaneCount samples of a row at once,
+ *          matches the scalar version up to float rounding
+ */
+void UPerlinNoise::GenerateOctavePerlinSmoothedTile(float* OutValues, FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, int32 _stride, int32 _octaves, float _persistence, float _frequency, int _seed, float _gradientPower, float _gradientSmoothing, FVector2D eps, EPerlinNoiseVersion _version, const FPerlinLatticeCache* _lattice)
+{
+    // Gradients are computed once per lattice point instead of four times per sample and octave
+    FPerlinLatticeCache LocalLattice;
+    if (!_lattice)
+    {
+        LocalLattice.Build(_origin, GetTileMaxCoordinates(_origin, _step, _sizeX, _sizeY, eps), _octaves, _frequency, _seed, _version);
+        _lattice = &LocalLattice;
+    }
+    check(_lattice->Octaves.Num() >= _octaves);
+
+    GetSmoothedTileKernel(_octaves, _version)(OutValues, _origin, _step, _sizeX, _sizeY, _stride, _octaves, _persistence, _frequency, _gradientPower, _gradientSmoothing, eps, *_lattice);
+}
+
+/**
+ * @brief Selects the tile kernel matching a noise setup
+ * @param _octaves Number of noise octaves
+ * @param _version Gradient generation scheme
+ * @return Kernel with an unrolled octave loop for 2 to 8 octaves, generic kernel otherwise
+ * @details Resolved once per job so the per-block calls neither branch on the version nor loop over a runtime octave count
+ */
+FPerlinSmoothedTileKernel UPerlinNoise::GetSmoothedTileKernel(int32 _octaves, EPerlinNoiseVersion _version)
+{
+    using namespace PerlinNoiseSimd;
+
+    if (_version == EPerlinNoiseVersion::HashedAnalytic)
+    {
+        return SelectSmoothedTileKernel<true>(_octaves);
+    }
+    return SelectSmoothedTileKernel<false>(_octaves);
+}
+
+/**
+ * @brief Highest coordinates sampled by GenerateOctavePerlinSmoothedTile
+ * @param _origin Coordinates of the first sample
+ * @param _step Distance between two samples
+ * @param _sizeX Number of samples per row
+ * @param _sizeY Number of rows
+ * @param eps Small value for gradient calculation
+ * @return Upper bound of the region to cover with a FPerlinLatticeCache
+ * @details Rows are padded to a whole number of lanes, so the last vector may sample past _sizeX
+ */
+FVector2f UPerlinNoise::GetTileMaxCoordinates(FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, FVector2D eps)
+{
+    const int32 PaddedSizeX = Align(_sizeX, PerlinNoiseSimd::LaneCount);
+    return FVector2f(
+        _origin.X + (PaddedSizeX - 1) * _step + static_cast<float>(eps.X),
+        _origin.Y + (_sizeY - 1) * _step + static_cast<float>(eps.Y));
+}
+
+/**
+ * @brief Fills the cache with the gradient of every lattice point touched by samples inside a region
+ * @param _min Lowest sample coordinates of the region
+ * @param _max Highest sample coordinates of the region
+ * @param _octave Octave level
+ * @param _frequency Frequency of the octave
+ * @param _seed Random seed
+ * @param _version Gradient generation scheme
+ * @details One lattice point of margin on each side absorbs float rounding of the scaled coordinates
+ */
+void FLatticeGradientCache::Build(FVector2f _min, FVector2f _max, int32 _octave, float _frequency, int32 _seed, EPerlinNoiseVersion _version)
+{
+    MinX = FMath::FloorToInt(_min.X * _frequency) - 1;
+    MinY = FMath::FloorToInt(_min.Y * _frequency) - 1;
+    Width = FMath::FloorToInt(_max.X * _frequency) + 3 - MinX;
+    Height = FMath::FloorToInt(_max.Y * _frequency) + 3 - MinY;
+
+    Gradients.SetNumUninitialized(Width * Height);
+    for (int32 y = 0; y < Height; y++)
+    {
+        for (int32 x = 0; x < Width; x++)
+        {
+            if (_version == EPerlinNoiseVersion::Legacy)
+            {
+                const FVector Gradient = UPerlinNoise::GenerateVector(MinX + x, MinY + y, _octave, _seed, _version);
+                Gradients[y * Width + x] = FVector2f(Gradient.X, Gradient.Y);
+            }
+            else
+            {
+                Gradients[y * Width + x] = UPerlinNoise::GetHashedGradient(MinX + x, MinY + y, _octave, _seed);
+            }
+        }
+    }
+}
+
+void FPerlinLatticeCache::Build(FVector2f _min, FVector2f _max, int32 _octaves, float _frequency, int32 _seed, EPerlinNoiseVersion _version)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FPerlinLatticeCache::Build);
+    SCOPE_CYCLE_COUNTER(STAT_PTG_NoiseLattice);
+
+    Octaves.SetNum(_octaves);
+
+    float Frequency = _frequency;
+    for (int32 i = 0; i < _octaves; i++)
+    {
+        Octaves[i].Build(_min, _max, i, Frequency, _seed, _version);
+        Frequency = Frequency * 2.0f;
+    }
+}
+
 /**
  * @brief Generates base Perlin noise value
  * @param _x X coordinate
@@ -135,9 +532,10 @@ float UPerlinNoise::GenerateOctavePerlinSmoothed(float _x, float _y, int32 _octa
  * @param _octave Current octave level
  * @param _frequency Noise frequency
  * @param _seed Random seed
+ * @param _version Gradient generation scheme
  * @return Base noise value
  */
-float UPerlinNoise::GeneratePerlinValue(float _x, float _y, int _octave, float _frequency, int _seed)
+float UPerlinNoise::GeneratePerlinValue(float _x, float _y, int _octave, float _frequency, int _seed, EPerlinNoiseVersion _version)
 {
     // Scale input coordinates with frequency
     _x = _x * _frequency;
@@ -152,10 +550,10 @@ float UPerlinNoise::GeneratePerlinValue(float _x, float _y, int _octave, float _
     float sy = _y - y0;
     
     // Calculate dot products
-    float a1 = DotValue(GenerateVector(x0, y0, _octave,_seed), x0, y0, _x, _y);
-    float a2 = DotValue(GenerateVector(x1, y0, _octave,_seed), x1, y0, _x, _y);
-    float a3 = DotValue(GenerateVector(x0, y1, _octave,_seed), x0, y1, _x, _y);
-    float a4 = DotValue(GenerateVector(x1, y1, _octave,_seed), x1, y1, _x, _y);
+    float a1 = DotValue(GenerateVector(x0, y0, _octave,_seed, _version), x0, y0, _x, _y);
+    float a2 = DotValue(GenerateVector(x1, y0, _octave,_seed, _version), x1, y0, _x, _y);
+    float a3 = DotValue(GenerateVector(x0, y1, _octave,_seed, _version), x0, y1, _x, _y);
+    float a4 = DotValue(GenerateVector(x1, y1, _octave,_seed, _version), x1, y1, _x, _y);
     
     // Interpolate
     float b1 = FMath::Lerp(a1, a2, ((sx*6 - 15)*sx+10)*sx*sx*sx);
@@ -165,16 +563,74 @@ float UPerlinNoise::GeneratePerlinValue(float _x, float _y, int _octave, float _
     return value;
 }
 
+/**
+ * @brief Generates base Perlin noise value and its analytic derivative
+ * @param _x X coordinate
+ * @param _y Y coordinate
+ * @param _octave Current octave level
+ * @param _frequency Noise frequency
+ * @param _seed Random seed
+ * @param OutDerivative Derivative of the noise with respect to _x and _y
+ * @param _version Gradient generation scheme
+ * @return Base noise value, identical to GeneratePerlinValue
+ * @details The quintic fade is differentiated exactly, so value and gradient come out of a single lattice lookup
+ */
+float UPerlinNoise::GeneratePerlinValueWithDerivative(float _x, float _y, int _octave, float _frequency, int _seed, FVector2f& OutDerivative, EPerlinNoiseVersion _version)
+{
+    _x = _x * _frequency;
+    _y = _y * _frequency;
+
+    int x0 = FMath::FloorToInt(_x);
+    int y0 = FMath::FloorToInt(_y);
+
+    float sx = _x - x0;
+    float sy = _y - y0;
+
+    const FVector g1 = GenerateVector(x0, y0, _octave, _seed, _version);
+    const FVector g2 = GenerateVector(x0 + 1, y0, _octave, _seed, _version);
+    const FVector g3 = GenerateVector(x0, y0 + 1, _octave, _seed, _version);
+    const FVector g4 = GenerateVector(x0 + 1, y0 + 1, _octave, _seed, _version);
+
+    float a1 = DotValue(g1, x0, y0, _x, _y);
+    float a2 = DotValue(g2, x0 + 1, y0, _x, _y);
+    float a3 = DotValue(g3, x0, y0 + 1, _x, _y);
+    float a4 = DotValue(g4, x0 + 1, y0 + 1, _x, _y);
+
+    float u = ((sx * 6 - 15) * sx + 10) * sx * sx * sx;
+    float v = ((sy * 6 - 15) * sy + 10) * sy * sy * sy;
+    float du = 30 * sx * sx * (sx - 1) * (sx - 1);
+    float dv = 30 * sy * sy * (sy - 1) * (sy - 1);
+
+    float k1 = a2 - a1;
+    float k2 = a3 - a1;
+    float k3 = a1 - a2 - a3 + a4;
+
+    float dx = FMath::Lerp(FMath::Lerp(g1.X, g2.X, u), FMath::Lerp(g3.X, g4.X, u), v) + du * (k1 + k3 * v);
+    float dy = FMath::Lerp(FMath::Lerp(g1.Y, g2.Y, u), FMath::Lerp(g3.Y, g4.Y, u), v) + dv * (k2 + k3 * u);
+    OutDerivative = FVector2f(dx * _frequency, dy * _frequency);
+
+    float b1 = FMath::Lerp(a1, a2, u);
+    float b2 = FMath::Lerp(a3, a4, u);
+    return FMath::Lerp(b1, b2, v);
+}
+
 /**
  * @brief Generates random gradient vector for noise calculation
  * @param _x Grid X coordinate
  * @param _y Grid Y coordinate
  * @param _octave Octave level
  * @param _seed Random seed
+ * @param _version Gradient generation scheme
  * @return Random unit vector
  */
-FVector UPerlinNoise::GenerateVector(int _x, int _y, int _octave, int _seed)
+FVector UPerlinNoise::GenerateVector(int _x, int _y, int _octave, int _seed, EPerlinNoiseVersion _version)
 {
+    if (_version != EPerlinNoiseVersion::Legacy)
+    {
+        const FVector2f& Gradient = GetHashedGradient(_x, _y, _octave, _seed);
+        return FVector(Gradient.X, Gradient.Y, 0.0);
+    }
+
     std::mt19937 generator(((_seed * 1518 + _x) * 1794 + _y)*1816 + _octave);
     std::uniform_real_distribution<double> uniform(0.0, 1.0);
     double theta = 2 * M_PI * uniform(generator);
@@ -185,15 +641,93 @@ FVector UPerlinNoise::GenerateVector(int _x, int _y, int _octave, int _seed)
     return FVector(x, y, z);
 }
 
+/**
+ * @brief Hashes a lattice point into a well distributed 32 bits value
+ * @param _x Grid X coordinate
+ * @param _y Grid Y coordinate
+ * @param _octave Octave level
+ * @param _seed Random seed
+ * @return Hash of the lattice point
+ * @details Chained PCG output permutations, cheap enough to run per lookup
+ */
+uint32 UPerlinNoise::HashLatticePoint(int32 _x, int32 _y, int32 _octave, int32 _seed)
+{
+    auto Pcg = [](uint32 Value)
+    {
+        const uint32 State = Value * 747796405u + 2891336453u;
+        const uint32 Word = ((State >> ((State >> 28u) + 4u)) ^ State) * 277803737u;
+        return (Word >> 22u) ^ Word;
+    };
+
+    return Pcg(static_cast<uint32>(_x) ^ Pcg(static_cast<uint32>(_y) ^ Pcg(static_cast<uint32>(_octave) ^ Pcg(static_cast<uint32>(_seed)))));
+}
+
+/**
+ * @brief Looks up the gradient of a lattice point in the hashed mode
+ * @param _x Grid X coordinate
+ * @param _y Grid Y coordinate
+ * @param _octave Octave level
+ * @param _seed Random seed
+ * @return Gradient of the lattice point
+ */
+const FVector2f& UPerlinNoise::GetHashedGradient(int32 _x, int32 _y, int32 _octave, int32 _seed)
+{
+    return GetGradientTable()[HashLatticePoint(_x, _y, _octave, _seed) & (GradientTableSize - 1)];
+}
+
+/**
+ * @brief Gradient table of the hashed mode
+ * @return GradientTableSize gradients
+ * @details Points evenly spread over the unit sphere and projected on the XY plane,
+ *          matching the gradient length distribution of the legacy generator
+ */
+const FVector2f* UPerlinNoise::GetGradientTable()
+{
+    struct FGradientTable
+    {
+        FVector2f Gradients[GradientTableSize];
+
+        FGradientTable()
+        {
+            const double GoldenAngle = M_PI * (3.0 - FMath::Sqrt(5.0));
+            for (int32 i = 0; i < GradientTableSize; i++)
+            {
+                const double z = 1.0 - (2.0 * i + 1.0) / GradientTableSize;
+                const double Radius = FMath::Sqrt(1.0 - z * z);
+                const double Theta = GoldenAngle * i;
+                Gradients[i] = FVector2f(Radius * FMath::Cos(Theta), Radius * FMath::Sin(Theta));
+            }
+        }
+    };
+
+    static const FGradientTable Table;
+    return Table.Gradients;
+}
+
 #if WITH_EDITOR
 /**
- * @brief Creates a 2D texture from Perlin noise
- * @param TextureSize Dimensions of output texture
- * @param AssetPath Path to save generated texture
- * @return Generated texture object
+ * @brief Creates a heightmap texture asset of the terrain
+ * @param Settings Region and format of the texture
+ * @param Parameters Base height noise
+ * @param BiomesParameters Biome mask noise
+ * @param Layers Layers and height settings
+ * @param AssetPath Path to save generated texture, relative to /Game/
+ * @return Generated texture object, null if the texture is too large
+ * @details Tiles are evaluated in parallel by FHeightmapExporter with the chunk generator kernels. The whole image
+ *          lives in the texture source, heightmaps larger than MaxTextureSize are exported to raw files instead
  */
-UTexture2D* UPerlinNoise::GeneratePerlinNoise2D(FVector2D TextureSize, FString AssetPath)
+UTexture2D* UPerlinNoise::GeneratePerlinNoise2D(const FHeightmapExportSettings& Settings, const FPerlinParameters& Parameters, const FPerlinParameters& BiomesParameters, const FTerrainLayerSettings& Layers, FString AssetPath)
 {
+    TRACE_CPUPROFILER_EVENT_SCOPE(UPerlinNoise::GeneratePerlinNoise2D);
+
+    const FHeightmapExporter Exporter(Settings, Parameters, BiomesParameters, Layers);
+    const FIntPoint Size = Exporter.GetSettings().Size;
+    if (Size.X > MaxTextureSize || Size.Y > MaxTextureSize)
+    {
+        UE_LOG(LogPTG, Error, TEXT("Heightmap %dx%d is too large for a texture, export it to a raw file with the PTGHeightmapExport commandlet"), Size.X, Size.Y);
+        return nullptr;
+    }
+
     FString PackagePath = TEXT("/Game/") + AssetPath;
     UPackage* Package = CreatePackage(*PackagePath);
 
@@ -207,43 +741,14 @@ UTexture2D* UPerlinNoise::GeneratePerlinNoise2D(FVector2D TextureSize, FString A
         RF_Public | RF_Standalone | RF_MarkAsRootSet
     );
 
-    // Create texture source
-    int32 SizeX = FMath::RoundToInt(TextureSize.X);
-    int32 SizeY = FMath::RoundToInt(TextureSize.Y);
-    NoiseTexture->Source.Init(SizeX, SizeY, 1, 1, TSF_BGRA8);
-
-    // Lock the texture source for editing
-    uint8* MipData = NoiseTexture->Source.LockMip(0);
-
-    // Generate a separate grid for each octave, but keep the same size
-
-    // Generate and fill texture data
-    for (int32 y = 0; y < SizeY; y++)
-    {
-        for (int32 x = 0; x < SizeX; x++)
-        {
-            // Generate noise value for this pixel
-            float NoiseValue = GenerateOctavePerlinValue(x, y,octave,persistance,frequency,0);
-
-            // Convert from [-1,1] to [0,255] range
-            uint8 ColorIntensity = FMath::Clamp(((NoiseValue + 1.0f) / 2)*255,0,255);
-
-            // Calculate pixel index
-            int32 Index = ((y * SizeX) + x) * 4;
-
-            // Set pixel color (BGRA format)
-            MipData[Index] = ColorIntensity;     // Blue
-            MipData[Index + 1] = ColorIntensity; // Green
-            MipData[Index + 2] = ColorIntensity; // Red
-            MipData[Index + 3] = 255;           // Alpha
-        }
-    }
-
-    // Unlock the texture source
+    // Single channel source, heights are written straight into the locked mip
+    const bool bFloat = Settings.Format == EHeightmapFormat::R32F;
+    NoiseTexture->Source.Init(Size.X, Size.Y, 1, 1, bFloat ? TSF_R32F : TSF_G16);
+    Exporter.ExportToMemory(NoiseTexture->Source.LockMip(0));
     NoiseTexture->Source.UnlockMip(0);
 
     // Set texture properties
-    NoiseTexture->CompressionSettings = TextureCompressionSettings::TC_VectorDisplacementmap;
+    NoiseTexture->CompressionSettings = bFloat ? TextureCompressionSettings::TC_SingleFloat : TextureCompressionSettings::TC_Grayscale;
     NoiseTexture->MipGenSettings = TMGS_NoMipmaps;
     NoiseTexture->SRGB = false;
     NoiseTexture->UpdateResource();
@@ -2,8 +2,53 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "PTG/Generation/Terrain/ChunkData.h"
 #include "PerlinNoise.generated.h"
 
+//////// STRUCTS ////////
+/// Dense block of the lattice gradients of one octave, shared by every sample of a tile
+struct PTG_API FLatticeGradientCache
+{
+	//////// METHODS ////////
+	void Build(FVector2f _min, FVector2f _max, int32 _octave, float _frequency, int32 _seed, EPerlinNoiseVersion _version);
+
+	FORCEINLINE const FVector2f& Get(int32 _x, int32 _y) const
+	{
+		checkSlow(_x >= MinX && _x < MinX + Width && _y >= MinY && _y < MinY + Height);
+		return Gradients[(_y - MinY) * Width + (_x - MinX)];
+	}
+
+	//////// FIELDS ////////
+	/// Covered lattice points
+	int32 MinX = 0;
+	int32 MinY = 0;
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<FVector2f> Gradients;
+};
+
+/// Lattice gradient caches of every octave of a tile
+struct PTG_API FPerlinLatticeCache
+{
+	//////// METHODS ////////
+	/**
+	 * @brief Fills the caches for every lattice point touched by samples inside a region
+	 * @param _min Lowest sample coordinates of the region
+	 * @param _max Highest sample coordinates of the region, including the tail lanes and smoothing offsets
+	 * @param _octaves Number of octaves
+	 * @param _frequency Base frequency, doubled at each octave
+	 * @param _seed Random seed
+	 * @param _version Gradient generation scheme
+	 */
+	void Build(FVector2f _min, FVector2f _max, int32 _octaves, float _frequency, int32 _seed, EPerlinNoiseVersion _version);
+
+	//////// FIELDS ////////
+	TArray<FLatticeGradientCache, TInlineAllocator<8>> Octaves;
+};
+
+/// Tile kernel specialized on the octave count and smoothing scheme, see UPerlinNoise::GetSmoothedTileKernel
+typedef void (*FPerlinSmoothedTileKernel)(float* OutValues, FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, int32 _stride, int32 _octaves, float _persistence, float _frequency, float _gradientPower, float _gradientSmoothing, FVector2D eps, const FPerlinLatticeCache& _lattice);
+
 //////// FIELDS ////////
 /// Thread data
 UCLASS()
@@ -22,17 +67,37 @@ public:
 
 	/// Core noise generation
 	static float DotValue(FVector gradient_vector, int x1, int y1, float x, float y);
-	static float GeneratePerlinValue(float _x, float _y, int _octave, float _frequency, int _seed);
+	static float GeneratePerlinValue(float _x, float _y, int _octave, float _frequency, int _seed, EPerlinNoiseVersion _version = EPerlinNoiseVersion::Legacy);
 	UFUNCTION(BlueprintCallable)
-	static float GenerateOctavePerlinValue(float _x, float _y, int32 _octaves, float _persistence, float _frequency,int _seed);
+	static float GenerateOctavePerlinValue(float _x, float _y, int32 _octaves, float _persistence, float _frequency,int _seed, EPerlinNoiseVersion _version = EPerlinNoiseVersion::Legacy);
 	UFUNCTION(BlueprintCallable)
-	static float GenerateOctavePerlinSmoothed(float _x, float _y, int32 _octaves, float _persistence, float _frequency, int _seed,float _gradientPower, float _gradientSmoothing, FVector2D eps);
-	static FVector GenerateVector(int _x, int _y, int _octave,int _seed);
+	static float GenerateOctavePerlinSmoothed(float _x, float _y, int32 _octaves, float _persistence, float _frequency, int _seed,float _gradientPower, float _gradientSmoothing, FVector2D eps, EPerlinNoiseVersion _version = EPerlinNoiseVersion::Legacy);
+	static float GeneratePerlinValueWithDerivative(float _x, float _y, int _octave, float _frequency, int _seed, FVector2f& OutDerivative, EPerlinNoiseVersion _version = EPerlinNoiseVersion::Legacy);
+	static FVector GenerateVector(int _x, int _y, int _octave,int _seed, EPerlinNoiseVersion _version = EPerlinNoiseVersion::Legacy);
+
+	/// Batch noise generation
+	static void GenerateOctavePerlinSmoothedTile(float* OutValues, FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, int32 _stride, int32 _octaves, float _persistence, float _frequency, int _seed, float _gradientPower, float _gradientSmoothing, FVector2D eps, EPerlinNoiseVersion _version = EPerlinNoiseVersion::Legacy, const FPerlinLatticeCache* _lattice = nullptr);
+	static FPerlinSmoothedTileKernel GetSmoothedTileKernel(int32 _octaves, EPerlinNoiseVersion _version);
+	static FVector2f GetTileMaxCoordinates(FVector2f _origin, float _step, int32 _sizeX, int32 _sizeY, FVector2D eps);
+
+	/// Samples of a row evaluated at once by the tile kernel, rows are padded to a multiple of it
+	static constexpr int32 TileLaneCount = 4;
+
+	/// Hashed gradients
+	static uint32 HashLatticePoint(int32 _x, int32 _y, int32 _octave, int32 _seed);
+	static const FVector2f& GetHashedGradient(int32 _x, int32 _y, int32 _octave, int32 _seed);
+	static const FVector2f* GetGradientTable();
+
+	/// Number of entries of the hashed gradient table, must be a power of two
+	static constexpr int32 GradientTableSize = 256;
 	
 #if WITH_EDITOR
 	/// Texture generation
 	UFUNCTION(BlueprintCallable)
-	UTexture2D* GeneratePerlinNoise2D(FVector2D TextureSize, FString AssetPath);
+	static UTexture2D* GeneratePerlinNoise2D(const FHeightmapExportSettings& Settings, const FPerlinParameters& Parameters, const FPerlinParameters& BiomesParameters, const FTerrainLayerSettings& Layers, FString AssetPath);
+
+	/// Largest texture side, larger heightmaps are streamed to raw files
+	static constexpr int32 MaxTextureSize = 8192;
 #endif
 
 private:
@@ -40,15 +105,6 @@ private:
 	/// Base settings
 	int32 seed;
 	
-	UPROPERTY(EditAnywhere)
-	float frequency = 0.05;
-	
-	UPROPERTY(EditAnywhere)
-	int octave = 4;
-	
-	UPROPERTY(EditAnywhere)
-	float persistance = 0.5;
-	
 	UPROPERTY(EditAnywhere)
 	int period = 16;
 
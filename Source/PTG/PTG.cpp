@@ -4,3 +4,33 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, PTG, "PTG" );
+
+//////// LOGS ////////
+DEFINE_LOG_CATEGORY(LogPTG);
+DEFINE_LOG_CATEGORY(LogPTGChunk);
+
+//////// STATS ////////
+DEFINE_STAT(STAT_PTG_WorkerJob);
+DEFINE_STAT(STAT_PTG_GenerateChunk);
+DEFINE_STAT(STAT_PTG_NoiseTile);
+DEFINE_STAT(STAT_PTG_NoiseLattice);
+DEFINE_STAT(STAT_PTG_GenerateApron);
+DEFINE_STAT(STAT_PTG_BuildMesh);
+DEFINE_STAT(STAT_PTG_UpdateStreaming);
+DEFINE_STAT(STAT_PTG_ProcessCompletedChunks);
+DEFINE_STAT(STAT_PTG_DisplayChunk);
+DEFINE_STAT(STAT_PTG_CreateChunkMesh);
+DEFINE_STAT(STAT_PTG_UploadChunkMesh);
+DEFINE_STAT(STAT_PTG_LoadedChunks);
+DEFINE_STAT(STAT_PTG_GenerationRequests);
+DEFINE_STAT(STAT_PTG_PendingChunks);
+DEFINE_STAT(STAT_PTG_QueuedJobs);
+DEFINE_STAT(STAT_PTG_InFlightJobs);
+DEFINE_STAT(STAT_PTG_HeightMemory);
+DEFINE_STAT(STAT_PTG_MeshMemory);
+DEFINE_STAT(STAT_PTG_CollisionMemory);
+DEFINE_STAT(STAT_PTG_PooledMeshMemory);
+DEFINE_STAT(STAT_PTG_PendingMemory);
+DEFINE_STAT(STAT_PTG_SharedMemory);
+DEFINE_STAT(STAT_PTG_MemoryBudget);
+DEFINE_STAT(STAT_PTG_LODRingWidth);
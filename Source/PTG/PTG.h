@@ -3,4 +3,50 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
+//////// LOGS ////////
+DECLARE_LOG_CATEGORY_EXTERN(LogPTG, Log, All);
+
+/// Per chunk events, Verbose by default and compiled out of shipping builds
+#if UE_BUILD_SHIPPING
+DECLARE_LOG_CATEGORY_EXTERN(LogPTGChunk, Warning, Warning);
+#else
+DECLARE_LOG_CATEGORY_EXTERN(LogPTGChunk, Log, All);
+#endif
+
+//////// STATS ////////
+DECLARE_STATS_GROUP(TEXT("PTG"), STATGROUP_PTG, STATCAT_Advanced);
+
+/// Workers
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Worker Job"), STAT_PTG_WorkerJob, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Chunk"), STAT_PTG_GenerateChunk, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Noise Tile"), STAT_PTG_NoiseTile, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Noise Lattice"), STAT_PTG_NoiseLattice, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Apron"), STAT_PTG_GenerateApron, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Mesh"), STAT_PTG_BuildMesh, STATGROUP_PTG, PTG_API);
+
+/// Game thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Streaming"), STAT_PTG_UpdateStreaming, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process Completed Chunks"), STAT_PTG_ProcessCompletedChunks, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Display Chunk"), STAT_PTG_DisplayChunk, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Create Chunk Mesh"), STAT_PTG_CreateChunkMesh, STATGROUP_PTG, PTG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Upload Chunk Mesh"), STAT_PTG_UploadChunkMesh, STATGROUP_PTG, PTG_API);
+
+/// Counters, set once per frame by the chunk manager
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Loaded Chunks"), STAT_PTG_LoadedChunks, STATGROUP_PTG, PTG_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Generation Requests"), STAT_PTG_GenerationRequests, STATGROUP_PTG, PTG_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Chunks"), STAT_PTG_PendingChunks, STATGROUP_PTG, PTG_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queued Jobs"), STAT_PTG_QueuedJobs, STATGROUP_PTG, PTG_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In Flight Jobs"), STAT_PTG_InFlightJobs, STATGROUP_PTG, PTG_API);
+
+/// Memory, measured by the terrain generator and set once per frame by the chunk manager
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Chunk Heights"), STAT_PTG_HeightMemory, STATGROUP_PTG, PTG_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Chunk Meshes"), STAT_PTG_MeshMemory, STATGROUP_PTG, PTG_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Chunk Collision"), STAT_PTG_CollisionMemory, STATGROUP_PTG, PTG_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Pooled Meshes"), STAT_PTG_PooledMeshMemory, STATGROUP_PTG, PTG_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Pending Chunks (Estimate)"), STAT_PTG_PendingMemory, STATGROUP_PTG, PTG_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Topologies And Containers"), STAT_PTG_SharedMemory, STATGROUP_PTG, PTG_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Memory Budget"), STAT_PTG_MemoryBudget, STATGROUP_PTG, PTG_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("LOD Ring Width"), STAT_PTG_LODRingWidth, STATGROUP_PTG, PTG_API);
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//////// NAMESPACE ////////
+namespace PTGTests
+{
+	//////// FIELDS ////////
+	/// Largest difference allowed between two evaluations of the smoothed noise, before height scaling.
+	/// Finite differences divide the rounding of two noise values by the smoothing epsilon, the bound covers it
+	constexpr float SmoothedNoiseTolerance = 1e-4f;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
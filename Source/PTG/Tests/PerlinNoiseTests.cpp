@@ -0,0 +1,167 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "PTG/Generation/Terrain/TerrainLayerGraph.h"
+#include "PTG/Generation/Utils/PerlinNoise.h"
+#include "PTG/Tests/PTGTestUtils.h"
+
+/**
+ * @file PerlinNoiseTests.cpp
+ * @brief Automation specs of the CPU Perlin noise
+ * @details The vectorized tile kernel is checked against the scalar smoothed noise over odd tile sizes, padded rows
+ *          and every noise version, the analytic noise derivative against central finite differences
+ */
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FPerlinNoiseSpec, "PTG.Generation.PerlinNoise", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+	/// Noise setup shared by the scalar and tile evaluations
+	float Persistence = 0.5f;
+	float Frequency = 0.1f;
+	int32 Seed = 1337;
+	float GradientPower = 3.0f;
+	float GradientSmoothing = 0.9f;
+
+	/// Value written in the row padding, the kernel must leave it untouched
+	static constexpr float PaddingSentinel = -12345.0f;
+
+	/// Half width of the central differences in lattice units, and their error bound on a derivative in lattice units
+	static constexpr float DerivativeStep = 1e-3f;
+	static constexpr float DerivativeTolerance = 2e-3f;
+
+	/**
+	 * @brief Fills a padded tile with the kernel and compares it with the scalar noise
+	 * @param Origin Coordinates of the first sample
+	 * @param Step Distance between two samples
+	 * @param SizeX Number of samples per row
+	 * @param SizeY Number of rows
+	 * @param Octaves Number of noise octaves
+	 * @param Version Gradient generation scheme
+	 */
+	void TestTileMatchesScalar(FVector2f Origin, float Step, int32 SizeX, int32 SizeY, int32 Octaves, EPerlinNoiseVersion Version)
+	{
+		const FVector2D Epsilon = FTerrainLayerGraph::SmoothingEpsilon;
+
+		// One extra lane of padding past the aligned row catches tail vectors written beyond the tile
+		const int32 Stride = Align(SizeX, UPerlinNoise::TileLaneCount) + UPerlinNoise::TileLaneCount;
+		TArray<float> Values;
+		Values.Init(PaddingSentinel, Stride * SizeY);
+
+		UPerlinNoise::GenerateOctavePerlinSmoothedTile(Values.GetData(), Origin, Step, SizeX, SizeY, Stride, Octaves, Persistence, Frequency, Seed,
+			GradientPower, GradientSmoothing, Epsilon, Version);
+
+		float MaxError = 0.0f;
+		bool bPaddingIntact = true;
+		for (int32 y = 0; y < SizeY; y++)
+		{
+			for (int32 x = 0; x < Stride; x++)
+			{
+				const float Value = Values[y * Stride + x];
+				if (x >= SizeX)
+				{
+					bPaddingIntact &= Value == PaddingSentinel;
+					continue;
+				}
+
+				const float Expected = UPerlinNoise::GenerateOctavePerlinSmoothed(Origin.X + x * Step, Origin.Y + y * Step, Octaves, Persistence, Frequency, Seed,
+					GradientPower, GradientSmoothing, Epsilon, Version);
+				MaxError = FMath::Max(MaxError, FMath::Abs(Value - Expected));
+			}
+		}
+
+		const FString Case = FString::Printf(TEXT("version %d, %dx%d tile, %d octaves"), (int32)Version, SizeX, SizeY, Octaves);
+		TestTrue(FString::Printf(TEXT("Tile matches the scalar noise, %s (max error %g)"), *Case, MaxError), MaxError <= PTGTests::SmoothedNoiseTolerance);
+		TestTrue(FString::Printf(TEXT("Row padding is left untouched, %s"), *Case), bPaddingIntact);
+	}
+
+	/**
+	 * @brief Compares the analytic derivative at a sample with central finite differences of the noise value
+	 * @param X X coordinate
+	 * @param Y Y coordinate
+	 * @param Octave Octave level
+	 * @param OctaveFrequency Frequency of the octave
+	 * @param Version Gradient generation scheme
+	 * @return Largest error of both derivative components, in lattice units
+	 * @details The differences divide by the distance between the representable sample coordinates rather than the
+	 *          requested step, so the quantization of the coordinates does not count as an error
+	 */
+	float GetDerivativeError(float X, float Y, int32 Octave, float OctaveFrequency, EPerlinNoiseVersion Version)
+	{
+		FVector2f Derivative;
+		const float Value = UPerlinNoise::GeneratePerlinValueWithDerivative(X, Y, Octave, OctaveFrequency, Seed, Derivative, Version);
+		TestNearlyEqual(TEXT("Value matches GeneratePerlinValue"), Value, UPerlinNoise::GeneratePerlinValue(X, Y, Octave, OctaveFrequency, Seed, Version), 1e-6f);
+
+		const float Step = DerivativeStep / OctaveFrequency;
+		const float XMin = X - Step;
+		const float XMax = X + Step;
+		const float YMin = Y - Step;
+		const float YMax = Y + Step;
+		const float DerivativeX = (UPerlinNoise::GeneratePerlinValue(XMax, Y, Octave, OctaveFrequency, Seed, Version) - UPerlinNoise::GeneratePerlinValue(XMin, Y, Octave, OctaveFrequency, Seed, Version)) / (XMax - XMin);
+		const float DerivativeY = (UPerlinNoise::GeneratePerlinValue(X, YMax, Octave, OctaveFrequency, Seed, Version) - UPerlinNoise::GeneratePerlinValue(X, YMin, Octave, OctaveFrequency, Seed, Version)) / (YMax - YMin);
+
+		return FMath::Max(FMath::Abs(Derivative.X - DerivativeX), FMath::Abs(Derivative.Y - DerivativeY)) / OctaveFrequency;
+	}
+
+END_DEFINE_SPEC(FPerlinNoiseSpec)
+
+void FPerlinNoiseSpec::Define()
+{
+	Describe(TEXT("GenerateOctavePerlinSmoothedTile"), [this]()
+	{
+		for (const EPerlinNoiseVersion Version : { EPerlinNoiseVersion::Legacy, EPerlinNoiseVersion::Hashed, EPerlinNoiseVersion::HashedAnalytic })
+		{
+			It(FString::Printf(TEXT("matches the scalar noise with version %d"), (int32)Version), [this, Version]()
+			{
+				// Sizes below, at and across the lane count, 1 and 9 octaves run the generic kernel, 2 to 8 the unrolled ones
+				for (const int32 Size : { 1, 3, 5, 7, 17, 37 })
+				{
+					for (const int32 Octaves : { 1, 2, 4, 8, 9 })
+					{
+						TestTileMatchesScalar(FVector2f(0.0f, 0.0f), 1.0f, Size, Size, Octaves, Version);
+					}
+				}
+
+				// Negative origins, a LOD step and non square tiles
+				TestTileMatchesScalar(FVector2f(-96.0f, -33.0f), 4.0f, 9, 5, 4, Version);
+				TestTileMatchesScalar(FVector2f(4096.0f, -2048.0f), 1.0f, 35, 3, 4, Version);
+			});
+		}
+	});
+
+	Describe(TEXT("GeneratePerlinValueWithDerivative"), [this]()
+	{
+		for (const EPerlinNoiseVersion Version : { EPerlinNoiseVersion::Legacy, EPerlinNoiseVersion::Hashed, EPerlinNoiseVersion::HashedAnalytic })
+		{
+			It(FString::Printf(TEXT("matches finite differences across lattice cells with version %d"), (int32)Version), [this, Version]()
+			{
+				// Power of two frequencies keep the lattice edges exactly representable
+				for (const float OctaveFrequency : { 1.0f, 0.25f })
+				{
+					for (int32 Octave = 0; Octave < 3; Octave++)
+					{
+						float MaxError = 0.0f;
+
+						// Cell edges and corners, just inside and outside them, then the cell interiors, on both sides of the origin
+						for (int32 LatticeY = -3; LatticeY <= 3; LatticeY++)
+						{
+							for (int32 LatticeX = -3; LatticeX <= 3; LatticeX++)
+							{
+								for (const float Offset : { 0.0f, 1e-4f, -1e-4f, 0.25f, 0.5f, 0.8125f })
+								{
+									const float X = (LatticeX + Offset) / OctaveFrequency;
+									const float Y = (LatticeY + 0.5f * Offset) / OctaveFrequency;
+									MaxError = FMath::Max(MaxError, GetDerivativeError(X, Y, Octave, OctaveFrequency, Version));
+									MaxError = FMath::Max(MaxError, GetDerivativeError(X, LatticeY / OctaveFrequency, Octave, OctaveFrequency, Version));
+								}
+							}
+						}
+
+						TestTrue(FString::Printf(TEXT("Frequency %g, octave %d (max error %g)"), OctaveFrequency, Octave, MaxError), MaxError <= DerivativeTolerance);
+					}
+				}
+			});
+		}
+	});
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
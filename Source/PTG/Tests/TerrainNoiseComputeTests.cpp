@@ -0,0 +1,150 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "RenderingThread.h"
+#include "PTG/Generation/Terrain/TerrainLayerGraph.h"
+#include "PTG/Generation/Utils/PerlinNoise.h"
+#include "PTG/Tests/PTGTestUtils.h"
+#include "PTGShaders/TerrainNoiseCompute.h"
+
+/**
+ * @file TerrainNoiseComputeTests.cpp
+ * @brief Automation specs of the compute shader noise against the CPU noise
+ * @details One dispatch of a few chunks, aprons included, is compared with UPerlinNoise::GenerateOctavePerlinSmoothed
+ *          sample by sample for every noise version the shader ports
+ */
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FTerrainNoiseComputeSpec, "PTG.Generation.TerrainNoiseCompute", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+	/// Longest wait for a batch to be read back
+	static constexpr double ReadbackTimeoutSeconds = 10.0;
+
+	/// Chunks of every dispatch, negative origins included
+	TArray<FIntPoint> ChunkOrigins = { FIntPoint(0, 0), FIntPoint(32, 0), FIntPoint(-32, -64), FIntPoint(4096, -2048) };
+
+	/**
+	 * @brief Offset in full resolution samples of an extended grid index, same layout as the shader
+	 * @param Index Index in the extended grid, 0 and Resolution + 1 are the aprons
+	 * @param Parameters Dispatch the grid comes from
+	 * @return Offset from the chunk origin
+	 */
+	static int32 GetExtendedSampleOffset(int32 Index, const FTerrainNoiseDispatchParameters& Parameters)
+	{
+		if (Index == 0)
+		{
+			return -Parameters.SampleStep;
+		}
+		if (Index == Parameters.Resolution + 1)
+		{
+			return Parameters.ChunkSize - 1 + Parameters.SampleStep;
+		}
+		return FMath::Min((Index - 1) * Parameters.SampleStep, Parameters.ChunkSize - 1);
+	}
+
+	/**
+	 * @brief Waits for a batch to be read back
+	 * @param Batch Dispatched batch
+	 * @return True once the heights are available
+	 */
+	static bool WaitForBatch(FTerrainNoiseComputeBatch& Batch)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		while (!Batch.Poll())
+		{
+			FlushRenderingCommands();
+			if (FPlatformTime::Seconds() - StartTime > ReadbackTimeoutSeconds)
+			{
+				return false;
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Dispatches the chunks at a LOD and compares their extended grids with the CPU noise
+	 * @param ChunkSize Size of chunk in full resolution samples
+	 * @param LOD Level of detail of the chunks
+	 * @param Version Gradient generation scheme, ported by the shader
+	 */
+	void TestDispatchMatchesCPU(int32 ChunkSize, int32 LOD, EPerlinNoiseVersion Version)
+	{
+		const FVector2D Epsilon = FTerrainLayerGraph::SmoothingEpsilon;
+
+		FTerrainNoiseDispatchParameters Parameters;
+		Parameters.ChunkOrigins = ChunkOrigins;
+		Parameters.ChunkSize = ChunkSize;
+		Parameters.SampleStep = 1 << LOD;
+		Parameters.Resolution = FChunk::GetLODResolution(ChunkSize, LOD);
+		Parameters.Octaves = 4;
+		Parameters.Frequency = 0.1f;
+		Parameters.Persistence = 0.5f;
+		Parameters.Seed = 1337;
+		Parameters.Epsilon = Epsilon.X;
+		Parameters.bAnalyticDerivative = Version == EPerlinNoiseVersion::HashedAnalytic;
+		Parameters.HeightScale = 1.0f;
+		Parameters.Gradients = TArray<FVector2f>(UPerlinNoise::GetGradientTable(), UPerlinNoise::GradientTableSize);
+
+		FTerrainNoiseDispatchParameters DispatchParameters = Parameters;
+		FTerrainNoiseComputeBatchPtr Batch = MakeShared<FTerrainNoiseComputeBatch, ESPMode::ThreadSafe>();
+		Batch->Dispatch(MoveTemp(DispatchParameters));
+		if (!TestTrue(TEXT("Batch read back"), WaitForBatch(*Batch)))
+		{
+			return;
+		}
+
+		const int32 GridResolution = Batch->GetGridResolution();
+		TestEqual(TEXT("Grid resolution includes the aprons"), GridResolution, Parameters.Resolution + 2);
+
+		for (int32 ChunkIndex = 0; ChunkIndex < Parameters.ChunkOrigins.Num(); ChunkIndex++)
+		{
+			const TConstArrayView<float> Heights = Batch->GetChunkHeights(ChunkIndex);
+			if (!TestEqual(TEXT("Chunk height count"), Heights.Num(), GridResolution * GridResolution))
+			{
+				return;
+			}
+
+			float MaxError = 0.0f;
+			for (int32 Y = 0; Y < GridResolution; Y++)
+			{
+				for (int32 X = 0; X < GridResolution; X++)
+				{
+					const float SampleX = Parameters.ChunkOrigins[ChunkIndex].X + GetExtendedSampleOffset(X, Parameters);
+					const float SampleY = Parameters.ChunkOrigins[ChunkIndex].Y + GetExtendedSampleOffset(Y, Parameters);
+					const float Expected = UPerlinNoise::GenerateOctavePerlinSmoothed(SampleX, SampleY, Parameters.Octaves, Parameters.Persistence, Parameters.Frequency, Parameters.Seed,
+						Parameters.GradientPower, Parameters.GradientSmoothing, Epsilon, Version);
+					MaxError = FMath::Max(MaxError, FMath::Abs(Heights[Y * GridResolution + X] - Expected));
+				}
+			}
+
+			TestTrue(FString::Printf(TEXT("Chunk %d matches the CPU noise (max error %g)"), ChunkIndex, MaxError), MaxError <= PTGTests::SmoothedNoiseTolerance);
+		}
+	}
+
+END_DEFINE_SPEC(FTerrainNoiseComputeSpec)
+
+void FTerrainNoiseComputeSpec::Define()
+{
+	Describe(TEXT("FTerrainNoiseComputeBatch"), [this]()
+	{
+		// Legacy gradients come from a per point std::mt19937 the shader does not port, those chunks stay on the CPU
+		for (const EPerlinNoiseVersion Version : { EPerlinNoiseVersion::Hashed, EPerlinNoiseVersion::HashedAnalytic })
+		{
+			It(FString::Printf(TEXT("matches the CPU noise with version %d"), (int32)Version), [this, Version]()
+			{
+				if (!FTerrainNoiseComputeBatch::IsSupported())
+				{
+					AddInfo(TEXT("Compute noise is not supported by this process, skipped"));
+					return;
+				}
+
+				// Full resolution chunks and a LOD whose step does not divide the chunk size, so the last sample is clamped
+				TestDispatchMatchesCPU(33, 0, Version);
+				TestDispatchMatchesCPU(35, 2, Version);
+			});
+		}
+	});
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
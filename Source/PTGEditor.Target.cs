@@ -10,6 +10,6 @@ public class PTGEditorTarget : TargetRules
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V5;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_4;
-		ExtraModuleNames.Add("PTG");
+		ExtraModuleNames.AddRange(new string[] { "PTG", "PTGShaders" });
 	}
 }
@@ -0,0 +1,13 @@
+using UnrealBuildTool;
+
+public class PTGShaders : ModuleRules
+{
+	public PTGShaders(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "CoreUObject", "Engine", "RenderCore", "RHI", "Renderer" });
+	}
+}
@@ -0,0 +1,24 @@
+#include "PTGShaders/PTGShaders.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "ShaderCore.h"
+
+/**
+ * @file PTGShaders.cpp
+ * @brief Registration of the project shader directory
+ */
+
+IMPLEMENT_MODULE(FPTGShadersModule, PTGShaders);
+
+/**
+ * @brief Maps the /PTGShaders virtual path to the Shaders directory of the project
+ */
+void FPTGShadersModule::StartupModule()
+{
+	const FString ShaderDirectory = FPaths::Combine(FPaths::ProjectDir(), TEXT("Shaders"));
+	AddShaderSourceDirectoryMapping(TEXT("/PTGShaders"), ShaderDirectory);
+}
+
+void FPTGShadersModule::ShutdownModule()
+{
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleInterface.h"
+
+//////// CLASS ////////
+/// Module owning the terrain compute shaders, loaded before the shader compiler looks up global shaders
+class FPTGShadersModule : public IModuleInterface
+{
+public:
+	//////// MODULE LIFECYCLE ////////
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+};
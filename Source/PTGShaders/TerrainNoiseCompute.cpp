@@ -0,0 +1,203 @@
+#include "PTGShaders/TerrainNoiseCompute.h"
+#include "DataDrivenShaderPlatformInfo.h"
+#include "GlobalShader.h"
+#include "Misc/App.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RenderingThread.h"
+#include "RHIGPUReadback.h"
+#include "ShaderParameterStruct.h"
+
+/**
+ * @file TerrainNoiseCompute.cpp
+ * @brief Compute shader evaluation of the hashed smoothed Perlin noise
+ * @details One render graph pass fills the grids of a whole batch of chunks, the result is copied to a staging
+ *          buffer and polled from the game thread so neither thread ever waits for the GPU
+ */
+
+//////// SHADER ////////
+/// Smoothed multi-octave hashed Perlin noise, one thread per grid sample and one group layer per chunk
+class FPTGTerrainNoiseCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FPTGTerrainNoiseCS);
+	SHADER_USE_PARAMETER_STRUCT(FPTGTerrainNoiseCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<int2>, ChunkOrigins)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<float2>, Gradients)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<float>, OutHeights)
+		SHADER_PARAMETER(int32, ChunkSize)
+		SHADER_PARAMETER(int32, SampleStep)
+		SHADER_PARAMETER(int32, Resolution)
+		SHADER_PARAMETER(int32, GridResolution)
+		SHADER_PARAMETER(int32, NumChunks)
+		SHADER_PARAMETER(int32, Octaves)
+		SHADER_PARAMETER(float, Frequency)
+		SHADER_PARAMETER(float, Persistence)
+		SHADER_PARAMETER(int32, Seed)
+		SHADER_PARAMETER(float, GradientPower)
+		SHADER_PARAMETER(float, GradientSmoothing)
+		SHADER_PARAMETER(float, Epsilon)
+		SHADER_PARAMETER(float, HeightScale)
+		SHADER_PARAMETER(uint32, GradientMask)
+		SHADER_PARAMETER(uint32, bAnalyticDerivative)
+	END_SHADER_PARAMETER_STRUCT()
+
+public:
+	static constexpr int32 ThreadGroupSize = 8;
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FPTGTerrainNoiseCS, "/PTGShaders/Private/PTGTerrainNoise.usf", "MainCS", SF_Compute);
+
+//////// BATCH ////////
+/**
+ * @brief Releases the staging buffer on the render thread if the batch is dropped before completion
+ */
+FTerrainNoiseComputeBatch::~FTerrainNoiseComputeBatch()
+{
+	if (Readback)
+	{
+		ENQUEUE_RENDER_COMMAND(PTGReleaseTerrainNoiseReadback)([Readback = Readback](FRHICommandListImmediate&)
+		{
+			delete Readback;
+		});
+		Readback = nullptr;
+	}
+}
+
+/**
+ * @brief Queues the noise pass of a batch of chunks and the copy of its result
+ * @param _parameters Chunks and noise parameters, moved to the render thread
+ * @details Must be called once, from the game thread, on a batch owned by a shared pointer.
+ *          Each chunk grid is extended by one sample on every side so aprons come out of the same pass
+ */
+void FTerrainNoiseComputeBatch::Dispatch(FTerrainNoiseDispatchParameters&& _parameters)
+{
+	check(IsInGameThread());
+	check(!Readback && !bComplete);
+
+	NumChunks = _parameters.ChunkOrigins.Num();
+	GridResolution = _parameters.Resolution + 2;
+
+	if (NumChunks == 0 || _parameters.Gradients.Num() == 0 || !FMath::IsPowerOfTwo(_parameters.Gradients.Num()))
+	{
+		bComplete = true;
+		return;
+	}
+
+	Readback = new FRHIGPUBufferReadback(TEXT("PTG.TerrainNoiseReadback"));
+
+	ENQUEUE_RENDER_COMMAND(PTGTerrainNoise)([Batch = AsShared(), Parameters = MoveTemp(_parameters)](FRHICommandListImmediate& RHICmdList)
+	{
+		const int32 NumChunks = Batch->NumChunks;
+		const int32 GridResolution = Batch->GridResolution;
+		const uint32 NumValues = GridResolution * GridResolution * NumChunks;
+
+		FRDGBuilder GraphBuilder(RHICmdList);
+
+		// Inputs stay alive in the capture until the graph is executed below
+		FRDGBufferRef OriginsBuffer = CreateStructuredBuffer(GraphBuilder, TEXT("PTG.TerrainNoise.ChunkOrigins"), sizeof(FIntPoint), NumChunks,
+			Parameters.ChunkOrigins.GetData(), sizeof(FIntPoint) * NumChunks);
+		FRDGBufferRef GradientsBuffer = CreateStructuredBuffer(GraphBuilder, TEXT("PTG.TerrainNoise.Gradients"), sizeof(FVector2f), Parameters.Gradients.Num(),
+			Parameters.Gradients.GetData(), sizeof(FVector2f) * Parameters.Gradients.Num());
+		FRDGBufferRef HeightsBuffer = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(sizeof(float), NumValues), TEXT("PTG.TerrainNoise.Heights"));
+
+		FPTGTerrainNoiseCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FPTGTerrainNoiseCS::FParameters>();
+		PassParameters->ChunkOrigins = GraphBuilder.CreateSRV(OriginsBuffer);
+		PassParameters->Gradients = GraphBuilder.CreateSRV(GradientsBuffer);
+		PassParameters->OutHeights = GraphBuilder.CreateUAV(HeightsBuffer);
+		PassParameters->ChunkSize = Parameters.ChunkSize;
+		PassParameters->SampleStep = Parameters.SampleStep;
+		PassParameters->Resolution = Parameters.Resolution;
+		PassParameters->GridResolution = GridResolution;
+		PassParameters->NumChunks = NumChunks;
+		PassParameters->Octaves = Parameters.Octaves;
+		PassParameters->Frequency = Parameters.Frequency;
+		PassParameters->Persistence = Parameters.Persistence;
+		PassParameters->Seed = Parameters.Seed;
+		PassParameters->GradientPower = Parameters.GradientPower;
+		PassParameters->GradientSmoothing = Parameters.GradientSmoothing;
+		PassParameters->Epsilon = Parameters.Epsilon;
+		PassParameters->HeightScale = Parameters.HeightScale;
+		PassParameters->GradientMask = Parameters.Gradients.Num() - 1;
+		PassParameters->bAnalyticDerivative = Parameters.bAnalyticDerivative ? 1 : 0;
+
+		TShaderMapRef<FPTGTerrainNoiseCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+		const int32 NumGroups = FMath::DivideAndRoundUp(GridResolution, FPTGTerrainNoiseCS::ThreadGroupSize);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PTG.TerrainNoise %d chunks", NumChunks), ComputeShader, PassParameters, FIntVector(NumGroups, NumGroups, NumChunks));
+
+		AddEnqueueCopyPass(GraphBuilder, Batch->Readback, HeightsBuffer, NumValues * sizeof(float));
+		GraphBuilder.Execute();
+	});
+}
+
+/**
+ * @brief Checks whether the heights of the batch have been read back
+ * @return True once GetChunkHeights can be called
+ * @details Called from the game thread, at most one readiness check is queued on the render thread at a time
+ */
+bool FTerrainNoiseComputeBatch::Poll()
+{
+	if (bComplete)
+	{
+		return true;
+	}
+
+	if (!bPollPending.exchange(true))
+	{
+		ENQUEUE_RENDER_COMMAND(PTGPollTerrainNoise)([Batch = AsShared()](FRHICommandListImmediate&)
+		{
+			if (Batch->Readback && Batch->Readback->IsReady())
+			{
+				const int32 NumValues = Batch->GridResolution * Batch->GridResolution * Batch->NumChunks;
+				Batch->Heights.SetNumUninitialized(NumValues);
+
+				const void* Data = Batch->Readback->Lock(NumValues * sizeof(float));
+				FMemory::Memcpy(Batch->Heights.GetData(), Data, NumValues * sizeof(float));
+				Batch->Readback->Unlock();
+
+				delete Batch->Readback;
+				Batch->Readback = nullptr;
+				Batch->bComplete = true;
+			}
+			Batch->bPollPending = false;
+		});
+	}
+
+	return bComplete;
+}
+
+/**
+ * @brief Returns the extended grid of a chunk of the batch
+ * @param _chunkIndex Index of the chunk in the dispatched origins
+ * @return GridResolution² heights, row-major, the first and last rows and columns are the aprons. Empty until complete
+ */
+TConstArrayView<float> FTerrainNoiseComputeBatch::GetChunkHeights(int32 _chunkIndex) const
+{
+	const int32 NumValues = GridResolution * GridResolution;
+	if (!bComplete || Heights.Num() < (_chunkIndex + 1) * NumValues)
+	{
+		return TConstArrayView<float>();
+	}
+	return MakeArrayView(Heights.GetData() + _chunkIndex * NumValues, NumValues);
+}
+
+/**
+ * @brief Tells whether compute noise can run on this process
+ * @return False without a renderer or below shader model 5
+ */
+bool FTerrainNoiseComputeBatch::IsSupported()
+{
+	return FApp::CanEverRender() && IsFeatureLevelSupported(GMaxRHIShaderPlatform, ERHIFeatureLevel::SM5);
+}
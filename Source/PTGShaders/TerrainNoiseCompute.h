@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+//////// FORWARD DECLARATION ////////
+/// Class
+class FRHIGPUBufferReadback;
+
+//////// STRUCTS ////////
+/// Inputs of a compute noise dispatch, every chunk of a batch shares its size, LOD and noise parameters
+struct FTerrainNoiseDispatchParameters
+{
+	/// Origin of each chunk in full resolution samples, the shader adds the sample offsets
+	TArray<FIntPoint> ChunkOrigins;
+
+	/// Size of chunk footprint in full resolution samples
+	int32 ChunkSize = 0;
+
+	/// Distance between two grid samples
+	int32 SampleStep = 1;
+
+	/// Grid samples per chunk side, the last one is clamped on the chunk edge
+	int32 Resolution = 0;
+
+	/// Noise parameters, the gradient table is the one of the CPU hashed noise
+	int32 Octaves = 0;
+	float Frequency = 0.0f;
+	float Persistence = 0.0f;
+	int32 Seed = 0;
+	float GradientPower = 3.0f;
+	float GradientSmoothing = 0.9f;
+	float Epsilon = 1.0f / 64.0f;
+	bool bAnalyticDerivative = false;
+	float HeightScale = 1.0f;
+	TArray<FVector2f> Gradients;
+};
+
+//////// CLASS ////////
+/// Batch of chunk height grids evaluated by a compute shader and read back asynchronously
+class PTGSHADERS_API FTerrainNoiseComputeBatch : public TSharedFromThis<FTerrainNoiseComputeBatch, ESPMode::ThreadSafe>
+{
+public:
+	//////// CONSTRUCTORS ////////
+	FTerrainNoiseComputeBatch() = default;
+	~FTerrainNoiseComputeBatch();
+
+	//////// METHODS ////////
+	/// Game thread interface
+	void Dispatch(FTerrainNoiseDispatchParameters&& _parameters);
+	bool Poll();
+
+	/// Getters
+	bool IsComplete() const { return bComplete; }
+	int32 GetNumChunks() const { return NumChunks; }
+	int32 GetGridResolution() const { return GridResolution; }
+	TConstArrayView<float> GetChunkHeights(int32 _chunkIndex) const;
+
+	/// Helpers
+	static bool IsSupported();
+
+private:
+	//////// FIELDS ////////
+	/// Heights of every chunk, GridResolution² values per chunk with one apron sample on every side
+	TArray<float> Heights;
+	int32 NumChunks = 0;
+	int32 GridResolution = 0;
+
+	/// Owned by the render thread once dispatched
+	FRHIGPUBufferReadback* Readback = nullptr;
+	std::atomic<bool> bComplete = false;
+	std::atomic<bool> bPollPending = false;
+};
+
+typedef TSharedPtr<FTerrainNoiseComputeBatch, ESPMode::ThreadSafe> FTerrainNoiseComputeBatchPtr;